@@ -0,0 +1,159 @@
+// Helpers shared by the benchmark modes of the triangle programs.
+//
+// The headless EGL part is only compiled when <EGL/egl.h> was included
+// first. It creates the display, context and (if needed) surface; the
+// caller loads GL and sets up its own FBO, since each program wants
+// different attachments.
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Sorts ms and prints its average and percentiles. Returns the sum.
+inline double print_percentiles(const char *label, std::vector<double> *ms) {
+  if (ms->empty()) {
+    return 0;
+  }
+
+  double total = 0;
+  for (double v : *ms) {
+    total += v;
+  }
+
+  std::sort(ms->begin(), ms->end());
+  auto percentile = [&](double p) {
+    size_t i = (size_t)(p * (ms->size() - 1) + 0.5);
+    return (*ms)[i];
+  };
+
+  printf("%s ms: avg %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n", label,
+         total / ms->size(), percentile(0.50), percentile(0.90),
+         percentile(0.99), ms->back());
+  return total;
+}
+
+#if defined(EGL_VERSION_1_0)
+struct HeadlessEgl {
+  EGLDisplay display;
+  EGLContext context;
+  EGLSurface surface;
+  bool surfaceless;
+};
+
+inline bool has_extension(const char *list, const char *name) {
+  if (list == nullptr) {
+    return false;
+  }
+
+  size_t len = strlen(name);
+  for (const char *p = strstr(list, name); p; p = strstr(p + len, name)) {
+    if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Prefers EGL_MESA_platform_surfaceless, which needs no window system at all.
+// Otherwise falls back to the default display with a 1x1 pbuffer. Desktop GL
+// contexts are core profile. The context is current when this returns true.
+inline bool create_headless_egl(HeadlessEgl *out, bool gles, int major,
+                                int minor) {
+  *out = {};
+
+  const char *client_exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  out->surfaceless =
+      has_extension(client_exts, "EGL_EXT_platform_base") &&
+      has_extension(client_exts, "EGL_MESA_platform_surfaceless");
+
+  if (out->surfaceless) {
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    out->display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA,
+                                        EGL_DEFAULT_DISPLAY, nullptr);
+  } else {
+    out->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  }
+
+  if (out->display == EGL_NO_DISPLAY ||
+      !eglInitialize(out->display, nullptr, nullptr)) {
+    fprintf(stderr, "eglInitialize failed: 0x%x\n", eglGetError());
+    return false;
+  }
+
+  const char *api = gles ? "GLES" : "GL";
+  if (!eglBindAPI(gles ? EGL_OPENGL_ES_API : EGL_OPENGL_API)) {
+    fprintf(stderr, "eglBindAPI(%s) failed\n", api);
+    return false;
+  }
+
+  EGLint config_attribs[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, gles ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_BIT,
+      EGL_NONE,
+  };
+
+  EGLConfig config = nullptr;
+  EGLint num_configs = 0;
+  eglChooseConfig(out->display, config_attribs, &config, 1, &num_configs);
+  if (num_configs == 0) {
+    fprintf(stderr, "no EGL config supports %s pbuffers\n", api);
+    return false;
+  }
+
+  EGLint context_attribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION, major,
+      EGL_CONTEXT_MINOR_VERSION, minor,
+      EGL_NONE, EGL_NONE,
+      EGL_NONE,
+  };
+  if (!gles) {
+    context_attribs[4] = EGL_CONTEXT_OPENGL_PROFILE_MASK;
+    context_attribs[5] = EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT;
+  }
+
+  out->context = eglCreateContext(out->display, config, EGL_NO_CONTEXT,
+                                  context_attribs);
+  if (out->context == EGL_NO_CONTEXT) {
+    fprintf(stderr, "eglCreateContext(%s %d.%d) failed: 0x%x\n", api, major,
+            minor, eglGetError());
+    return false;
+  }
+
+  out->surface = EGL_NO_SURFACE;
+  if (!out->surfaceless) {
+    EGLint pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    out->surface =
+        eglCreatePbufferSurface(out->display, config, pbuffer_attribs);
+  }
+
+  if (!eglMakeCurrent(out->display, out->surface, out->surface,
+                      out->context)) {
+    fprintf(stderr, "eglMakeCurrent failed: 0x%x\n", eglGetError());
+    return false;
+  }
+  return true;
+}
+
+inline void print_headless_egl(const HeadlessEgl *h, const char *renderer,
+                               const char *version) {
+  printf("headless: %s, %s (%s)\n",
+         h->surfaceless ? "EGL_MESA_platform_surfaceless" : "EGL pbuffer",
+         renderer, version);
+}
+
+inline void destroy_headless_egl(HeadlessEgl *h) {
+  eglMakeCurrent(h->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (h->surface != EGL_NO_SURFACE) {
+    eglDestroySurface(h->display, h->surface);
+  }
+  eglDestroyContext(h->display, h->context);
+  eglTerminate(h->display);
+  *h = {};
+}
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+// rlgl.h includes its GL 3.3 loader as "external/glad.h", which is where it
+// lives in raylib's source tree. This forwards to the glad2 loader in
+// include/glad, which only covers GL 3.3 core. The extension flags below are
+// the ones rlgl checks that it was not generated with, so they read as absent.
+
+#include <glad/gl.h>
+
+#define GLAD_GL_KHR_texture_compression_astc_hdr 0
+#define GLAD_GL_KHR_texture_compression_astc_ldr 0
+#define GLAD_GL_EXT_texture_compression_s3tc 0
+#define GLAD_GL_ARB_ES3_compatibility 0
+
+// rlgl maps RL_PIXELFORMAT_UNCOMPRESSED_R5G6B5 to it, but it is a GL 4.1 enum
+#ifndef GL_RGB565
+#define GL_RGB565 0x8D62
+#endif
@@ -45,11 +45,15 @@
 *   #define RLGL_ENABLE_OPENGL_DEBUG_CONTEXT
 *       Enable debug context (only available on OpenGL 4.3)
 *
+*   #define RLGL_NO_SIMD
+*       Use scalar code for vertex transforms (rlVertex3f(), rlVertexArray3f()) and matrix stack math
+*       (rlRotatef(), rlScalef(), rlMultMatrixf()...), even where SSE/AVX/NEON are available
+*
 *   rlgl capabilities could be customized just defining some internal
 *   values before library inclusion (default values listed):
 *
 *   #define RL_DEFAULT_BATCH_BUFFER_ELEMENTS   8192    // Default internal render batch elements limits
-*   #define RL_DEFAULT_BATCH_BUFFERS              1    // Default number of batch buffers (multi-buffering)
+*   #define RL_DEFAULT_BATCH_BUFFERS              1    // Default number of batch buffers (multi-buffering, fence-synced on OpenGL 3.3 if more than 1)
 *   #define RL_DEFAULT_BATCH_DRAWCALLS          256    // Default number of batch draw calls (by state changes: mode, texture)
 *   #define RL_DEFAULT_BATCH_MAX_TEXTURE_UNITS    4    // Maximum number of textures units that can be activated on batch drawing (SetShaderValueTexture())
 *
@@ -204,6 +208,9 @@
 #ifndef RL_DEFAULT_BATCH_BUFFERS
     #define RL_DEFAULT_BATCH_BUFFERS                 1      // Default number of batch buffers (multi-buffering)
 #endif
+#ifndef RL_BATCH_FENCE_TIMEOUT
+    #define RL_BATCH_FENCE_TIMEOUT          1000000000      // Maximum time to wait for the GPU to release a batch buffer (nanoseconds)
+#endif
 #ifndef RL_DEFAULT_BATCH_DRAWCALLS
     #define RL_DEFAULT_BATCH_DRAWCALLS             256      // Default number of batch draw calls (by state changes: mode, texture)
 #endif
@@ -333,13 +340,22 @@ typedef struct Matrix {
 #define RL_MATRIX_TYPE
 #endif
 
+// Interleaved vertex, as stored by render batches loaded with rlLoadRenderBatchInterleaved()
+typedef struct rlVertex {
+    float position[3];          // Vertex position (XYZ) (shader-location = 0)
+    float texcoord[2];          // Vertex texture coordinates (UV) (shader-location = 1)
+    unsigned char color[4];     // Vertex color (RGBA) (shader-location = 3)
+} rlVertex;
+
 // Dynamic vertex buffers (position + texcoords + colors + indices arrays)
+// NOTE: Interleaved buffers keep all vertex data in interleaved/vboId[0], vertices/texcoords/colors are NULL
 typedef struct rlVertexBuffer {
     int elementCount;           // Number of elements in the buffer (QUADS)
 
     float *vertices;            // Vertex position (XYZ - 3 components per vertex) (shader-location = 0)
     float *texcoords;           // Vertex texture coordinates (UV - 2 components per vertex) (shader-location = 1)
     unsigned char *colors;      // Vertex colors (RGBA - 4 components per vertex) (shader-location = 3)
+    rlVertex *interleaved;      // Vertex data interleaved (position, texcoords, color), NULL if using separate arrays
 #if defined(GRAPHICS_API_OPENGL_11) || defined(GRAPHICS_API_OPENGL_33)
     unsigned int *indices;      // Vertex indices (in case vertex data comes indexed) (6 indices per quad)
 #endif
@@ -348,6 +364,7 @@ typedef struct rlVertexBuffer {
 #endif
     unsigned int vaoId;         // OpenGL Vertex Array Object id
     unsigned int vboId[4];      // OpenGL Vertex Buffer Objects id (4 types of vertex data)
+    void *fence;                // OpenGL fence sync for the last draw from this buffer, waited on before reusing it (OpenGL 3.3 multi-buffering only)
 } rlVertexBuffer;
 
 // Draw call type
@@ -361,6 +378,7 @@ typedef struct rlDrawCall {
     //unsigned int vaoId;       // Vertex array id to be used on the draw -> Using RLGL.currentBatch->vertexBuffer.vaoId
     //unsigned int shaderId;    // Shader id to be used on the draw -> Using RLGL.currentShaderId
     unsigned int textureId;     // Texture id to be used on the draw -> Use to create new draw call if changes
+    int layer;                  // Draw layer, only used to order draws in deferred batches -> Use to create new draw call if changes
 
     //Matrix projection;        // Projection matrix for this draw -> Using RLGL.projection by default
     //Matrix modelview;         // Modelview matrix for this draw -> Using RLGL.modelview by default
@@ -375,8 +393,50 @@ typedef struct rlRenderBatch {
     rlDrawCall *draws;          // Draw calls array, depends on textureId
     int drawCounter;            // Draw calls counter
     float currentDepth;         // Current depth value for next draw
+
+    bool deferred;              // Sort draws by layer, texture and mode and merge them before drawing (see rlSortRenderBatch())
+    int drawsRecorded;          // Number of draws recorded into the batch (before merging)
+    int drawsIssued;            // Number of draws issued to OpenGL by rlDrawRenderBatch()
+    int fenceWaits;             // Number of times a vertex buffer was reused while the GPU was still reading it
+    void *sortScratch;          // Scratch copy of draws and vertex data for rlSortRenderBatch(), allocated on first sort
 } rlRenderBatch;
 
+// Instanced mesh, one triangle mesh drawn many times in a single draw call (see rlDrawInstancedMesh())
+typedef struct rlInstancedMesh {
+    int vertexCount;            // Number of mesh vertices (triangles*3)
+    int maxInstances;           // Number of instances the instance buffers can hold
+    unsigned int vaoId;         // OpenGL Vertex Array Object id
+    unsigned int vboId[3];      // OpenGL Vertex Buffer Objects id (mesh positions, instance transforms, instance colors)
+} rlInstancedMesh;
+
+// Texture atlas region, one image packed into an atlas
+typedef struct rlAtlasRegion {
+    int x, y;                   // Image position in the atlas (pixels, padding excluded)
+    int width, height;          // Image size (pixels)
+    float u0, v0, u1, v1;       // Image texture coordinates in the atlas
+} rlAtlasRegion;
+
+// Texture atlas node, skyline segment or free rectangle (atlas packer state)
+typedef struct rlAtlasNode {
+    int x, y;                   // Rectangle position, skyline segments: left end and top
+    int width, height;          // Rectangle size, skyline segments: width only
+} rlAtlasNode;
+
+// Texture atlas, RGBA8 texture images are packed into at runtime (see rlAtlasInsert())
+typedef struct rlAtlas {
+    unsigned int id;            // OpenGL texture id
+    int width, height;          // Atlas size (pixels)
+    int padding;                // Pixels kept around every image
+    bool extrude;               // Fill padding with the image edge pixels instead of transparent ones (no bleeding when filtering)
+
+    rlAtlasNode *skyline;       // Skyline segments, left to right (up to width, plus one spare)
+    int skylineCount;           // Skyline segments count
+    rlAtlasNode *freeRects;     // Evicted areas, reused before growing the skyline
+    int freeCount;              // Evicted areas count
+    int freeCapacity;           // Evicted areas array capacity
+    int usedArea;               // Pixels used by images (padding included)
+} rlAtlas;
+
 // OpenGL version
 typedef enum {
     RL_OPENGL_11 = 1,           // OpenGL 1.1
@@ -536,6 +596,27 @@ typedef enum {
     RL_CULL_FACE_BACK
 } rlCullMode;
 
+// Render batch flush causes
+// NOTE: rlgl itself does not flush on matrix changes, raylib flushes explicitly on BeginMode2D(), BeginMode3D()...
+typedef enum {
+    RL_FLUSH_EXPLICIT = 0,          // rlDrawRenderBatch() or rlDrawRenderBatchActive() called by the user
+    RL_FLUSH_BUFFER_FULL,           // No room left in the vertex buffer (rlCheckRenderBatchLimit(), rlSetTexture())
+    RL_FLUSH_DRAW_LIMIT,            // No draw call left (RL_DEFAULT_BATCH_DRAWCALLS)
+    RL_FLUSH_STATE_CHANGE,          // Shader, blend mode or active render batch changed
+    RL_FLUSH_CAUSE_COUNT
+} rlFlushCause;
+
+// Render batch statistics, accumulated by rlDrawRenderBatch() over all batches
+// NOTE: Only flushes with vertex data are counted, time is counted for all of them
+typedef struct rlBatchStats {
+    int flushes[RL_FLUSH_CAUSE_COUNT]; // Flushes by cause (rlFlushCause)
+    int vertices;                   // Vertices drawn (including alignment padding)
+    int maxVertices;                // Vertices drawn by the largest flush
+    int drawCalls;                  // Draw calls issued to OpenGL
+    double drawTime;                // Time spent in rlDrawRenderBatch() (seconds)
+    double maxDrawTime;             // Time spent in the slowest rlDrawRenderBatch() call (seconds)
+} rlBatchStats;
+
 //------------------------------------------------------------------------------------
 // Functions Declaration - Matrix operations
 //------------------------------------------------------------------------------------
@@ -569,6 +650,7 @@ RLAPI void rlNormal3f(float x, float y, float z);     // Define one vertex (norm
 RLAPI void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a);  // Define one vertex (color) - 4 byte
 RLAPI void rlColor3f(float x, float y, float z);          // Define one vertex (color) - 3 float
 RLAPI void rlColor4f(float x, float y, float z, float w); // Define one vertex (color) - 4 float
+RLAPI void rlVertexArray3f(const float *positions, const unsigned char *colors, int count); // Define many vertices (XYZ positions, RGBA colors or NULL for current color)
 
 //------------------------------------------------------------------------------------
 // Functions Declaration - OpenGL style functions (common to 1.1, 3.3+, ES2)
@@ -659,13 +741,20 @@ RLAPI int *rlGetShaderLocsDefault(void);                // Get default shader lo
 // NOTE: rlgl provides a default render batch to behave like OpenGL 1.1 immediate mode
 // but this render batch API is exposed in case of custom batches are required
 RLAPI rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements);  // Load a render batch system
+RLAPI rlRenderBatch rlLoadRenderBatchInterleaved(int numBuffers, int bufferElements); // Load a render batch system, with interleaved vertex data in a single VBO
 RLAPI void rlUnloadRenderBatch(rlRenderBatch batch);                        // Unload render batch system
 RLAPI void rlDrawRenderBatch(rlRenderBatch *batch);                         // Draw render batch data (Update->Draw->Reset)
 RLAPI void rlSetRenderBatchActive(rlRenderBatch *batch);                    // Set the active render batch for rlgl (NULL for default internal)
 RLAPI void rlDrawRenderBatchActive(void);                                   // Update and draw internal render batch
 RLAPI bool rlCheckRenderBatchLimit(int vCount);                             // Check internal buffer overflow for a given number of vertex
+RLAPI void rlSortRenderBatch(rlRenderBatch *batch);                         // Sort render batch draws by layer, texture and mode, and merge them (automatic for deferred batches)
+RLAPI rlBatchStats rlGetBatchStats(void);                                   // Get render batch statistics accumulated since the last reset
+RLAPI void rlResetBatchStats(void);                                         // Reset render batch statistics
+RLAPI void rlFinish(void);                                                  // Wait until the GPU has executed all submitted commands (to bound timings)
 
 RLAPI void rlSetTexture(unsigned int id);               // Set current texture for render batch and check buffers limits
+RLAPI void rlSetTextureRegion(unsigned int id, float u0, float v0, float u1, float v1); // Set current texture, mapping rlTexCoord2f() [0..1] to a region of it (until next rlSetTexture())
+RLAPI void rlSetDrawLayer(int layer);                   // Set current draw layer (-32768..32767), deferred batches draw lower layers first
 
 //------------------------------------------------------------------------------------------------------------------------
 
@@ -685,6 +774,13 @@ RLAPI void rlDrawVertexArrayElements(int offset, int count, const void *buffer);
 RLAPI void rlDrawVertexArrayInstanced(int offset, int count, int instances);
 RLAPI void rlDrawVertexArrayElementsInstanced(int offset, int count, const void *buffer, int instances);
 
+// Instanced meshes management
+// NOTE: Every instance has its own transform (applied before the current modelview) and RGBA color
+RLAPI rlInstancedMesh rlLoadInstancedMesh(const float *positions, int vertexCount, int maxInstances); // Load instanced mesh (XYZ positions, triangles) with room for maxInstances
+RLAPI void rlUnloadInstancedMesh(rlInstancedMesh mesh);                                  // Unload instanced mesh
+RLAPI void rlUpdateInstancedMesh(rlInstancedMesh mesh, const Matrix *transforms, const unsigned char *colors, int count); // Update first count instances transforms and RGBA colors (NULL to keep)
+RLAPI void rlDrawInstancedMesh(rlInstancedMesh mesh, int instances);                     // Draw first instances of the mesh in one call, after drawing the active batch
+
 // Textures management
 RLAPI unsigned int rlLoadTexture(const void *data, int width, int height, int format, int mipmapCount); // Load texture in GPU
 RLAPI unsigned int rlLoadTextureDepth(int width, int height, bool useRenderBuffer);               // Load depth texture/renderbuffer (to be attached to fbo)
@@ -697,6 +793,12 @@ RLAPI void rlGenTextureMipmaps(unsigned int id, int width, int height, int forma
 RLAPI void *rlReadTexturePixels(unsigned int id, int width, int height, int format);              // Read texture pixel data
 RLAPI unsigned char *rlReadScreenPixels(int width, int height);           // Read screen pixel data (color buffer)
 
+// Texture atlas management
+RLAPI rlAtlas rlLoadAtlas(int width, int height, int padding, bool extrude);  // Load an empty RGBA8 texture atlas
+RLAPI void rlUnloadAtlas(rlAtlas atlas);                                      // Unload texture atlas
+RLAPI bool rlAtlasInsert(rlAtlas *atlas, const void *data, int width, int height, rlAtlasRegion *region); // Pack RGBA8 image into atlas and upload it (false if it does not fit)
+RLAPI void rlAtlasEvict(rlAtlas *atlas, rlAtlasRegion region);                // Release an image area, reused by later insertions
+
 // Framebuffer management (fbo)
 RLAPI unsigned int rlLoadFramebuffer(int width, int height);              // Load an empty framebuffer
 RLAPI void rlFramebufferAttach(unsigned int fboId, unsigned int texId, int attachType, int texType, int mipLevel);  // Attach texture/renderbuffer to a framebuffer
@@ -813,8 +915,25 @@ RLAPI void rlLoadDrawQuad(void);     // Load and draw a quad
 #endif
 
 #include <stdlib.h>                     // Required for: malloc(), free()
-#include <string.h>                     // Required for: strcmp(), strlen() [Used in rlglInit(), on extensions loading]
+#include <string.h>                     // Required for: strcmp(), strlen() [Used in rlglInit(), on extensions loading], memcpy()
 #include <math.h>                       // Required for: sqrtf(), sinf(), cosf(), floor(), log()
+#include <time.h>                       // Required for: clock_gettime(), timespec_get() [Used in rlDrawRenderBatch(), for rlBatchStats]
+
+// SIMD support for vertex transforms and matrix stack math, SSE2 is baseline on x86_64, NEON on aarch64
+#if !defined(RLGL_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define RLGL_SIMD_SSE
+        #include <emmintrin.h>          // Required for: SSE2 intrinsics
+    #endif
+    #if defined(__AVX__)
+        #define RLGL_SIMD_AVX
+        #include <immintrin.h>          // Required for: AVX intrinsics
+    #endif
+    #if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+        #define RLGL_SIMD_NEON
+        #include <arm_neon.h>           // Required for: NEON intrinsics
+    #endif
+#endif
 
 //----------------------------------------------------------------------------------
 // Defines and Macros
@@ -946,10 +1065,12 @@ RLAPI void rlLoadDrawQuad(void);     // Load and draw a quad
 typedef struct rlglData {
     rlRenderBatch *currentBatch;            // Current render batch
     rlRenderBatch defaultBatch;             // Default internal render batch
+    rlBatchStats batchStats;                // Render batch statistics (see rlGetBatchStats())
 
     struct {
         int vertexCounter;                  // Current active render batch vertex counter (generic, used for all batches)
         float texcoordx, texcoordy;         // Current active texture coordinate (added on glVertex*())
+        float texcoordRegion[4];            // Current texture region (u0, v0, u1 - u0, v1 - v0), applied on rlTexCoord2f()
         float normalx, normaly, normalz;    // Current active normal (added on glVertex*())
         unsigned char colorr, colorg, colorb, colora;   // Current active color (added on glVertex*())
 
@@ -958,10 +1079,16 @@ typedef struct rlglData {
         Matrix modelview;                   // Default modelview matrix
         Matrix projection;                  // Default projection matrix
         Matrix transform;                   // Transform matrix to be used with rlTranslate, rlRotate, rlScale
+        float transformColumns[16];         // Transform matrix columns (m0..m3, m4..m7, m8..m11, m12..m15), for SIMD rlVertex3f()
+        bool transformChanged;              // Transform matrix changed since transformColumns were last updated
         bool transformRequired;             // Require transform matrix application to current draw-call vertex (if required)
         Matrix stack[RL_MAX_MATRIX_STACK_SIZE];// Matrix stack for push/pop
         int stackCounter;                   // Matrix stack counter
 
+        int drawLayer;                      // Current draw layer (sort key for deferred batches)
+        int flushCause;                     // Cause of the next rlDrawRenderBatch() (rlFlushCause), set right before internal flushes
+        unsigned int instancedShaderId;     // Instanced mesh shader program id, loaded by the first rlLoadInstancedMesh()
+        int instancedShaderLocs[4];         // Instanced mesh shader locations: mvp, vertexPosition, instanceColor, instanceTransform
         unsigned int defaultTextureId;      // Default texture used on shapes/poly drawing (required by shader)
         unsigned int activeTextureId[RL_DEFAULT_BATCH_MAX_TEXTURE_UNITS];    // Active texture ids to be enabled on batch drawing (0 active by default)
         unsigned int defaultVShaderId;      // Default vertex shader id (used by default shader program)
@@ -1026,6 +1153,10 @@ typedef void *(*rlglLoadProc)(const char *name);   // OpenGL extension functions
 static rlglData RLGL = { 0 };
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
+#if defined(GRAPHICS_API_OPENGL_11)
+static bool textureRegionPushed = false;    // Texture matrix pushed by rlSetTextureRegion(), popped by next rlSetTexture()
+#endif
+
 #if defined(GRAPHICS_API_OPENGL_ES2)
 // NOTE: VAO functionality is exposed through extensions (OES)
 static PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays = NULL;
@@ -1044,16 +1175,32 @@ static PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisor = NULL;
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
 static void rlLoadShaderDefault(void);      // Load default shader
 static void rlUnloadShaderDefault(void);    // Unload default shader
+static void rlSetVertexAttributesInterleaved(void); // Set vertex attributes for interleaved rlVertex data on bound VBO
+static void rlCheckRenderBatchDrawLimit(void);      // Make room for a new draw call, merging draws on deferred batches or drawing the batch
+static double rlGetClock(void);                     // Get a monotonic time in seconds, for render batch statistics
+static void rlLoadShaderInstanced(void);            // Load instanced mesh shader
+static void rlSetInstancedMeshAttributes(rlInstancedMesh mesh); // Set vertex attributes for instanced mesh buffers
 #if defined(RLGL_SHOW_GL_DETAILS_INFO)
 static char *rlGetCompressedFormatName(int format); // Get compressed format official GL identifier name
 #endif  // RLGL_SHOW_GL_DETAILS_INFO
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
 static int rlGetPixelDataSize(int width, int height, int format);   // Get pixel data size in bytes (image or texture)
+static rlRenderBatch rlLoadRenderBatchLayout(int numBuffers, int bufferElements, bool interleaved); // Load render batch, separate or interleaved vertex data
+static void rlAtlasAddFreeRect(rlAtlas *atlas, rlAtlasNode rect);  // Add an area to the atlas free rectangles
+static bool rlAtlasLowerSkyline(rlAtlas *atlas, rlAtlasNode rect); // Give an area right under the atlas skyline back to it
+static void rlAtlasMergeSkyline(rlAtlas *atlas);                   // Merge atlas skyline neighbour segments at the same height
 
 // Auxiliar matrix math functions
 static Matrix rlMatrixIdentity(void);                       // Get identity matrix
 static Matrix rlMatrixMultiply(Matrix left, Matrix right);  // Multiply two matrices
+static void rlMatrixMultiplyTo(const Matrix *left, const Matrix *right, Matrix *result); // Multiply two matrices into result (can be left or right)
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+static void rlCurrentMatrixChanged(void);                   // Flag transform columns for update if the current matrix is the transform
+#if defined(RLGL_SIMD_SSE) || defined(RLGL_SIMD_NEON)
+static void rlUpdateTransformColumns(void);                 // Transpose transform matrix into RLGL.State.transformColumns
+#endif
+#endif
 
 //----------------------------------------------------------------------------------
 // Module Functions Definition - Matrix operations
@@ -1124,6 +1271,7 @@ void rlPopMatrix(void)
     {
         Matrix mat = RLGL.State.stack[RLGL.State.stackCounter - 1];
         *RLGL.State.currentMatrix = mat;
+        rlCurrentMatrixChanged();
         RLGL.State.stackCounter--;
     }
 
@@ -1138,20 +1286,22 @@ void rlPopMatrix(void)
 void rlLoadIdentity(void)
 {
     *RLGL.State.currentMatrix = rlMatrixIdentity();
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by a translation matrix
 void rlTranslatef(float x, float y, float z)
 {
-    Matrix matTranslation = {
-        1.0f, 0.0f, 0.0f, x,
-        0.0f, 1.0f, 0.0f, y,
-        0.0f, 0.0f, 1.0f, z,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
+    // NOTE: Multiplying by a translation matrix (on the left) only changes m12..m15,
+    // those are the last element of every memory row, so SIMD would only add shuffles here
+    Matrix *mat = RLGL.State.currentMatrix;
+
+    mat->m12 = (x*mat->m0 + y*mat->m4) + (z*mat->m8 + mat->m12);
+    mat->m13 = (x*mat->m1 + y*mat->m5) + (z*mat->m9 + mat->m13);
+    mat->m14 = (x*mat->m2 + y*mat->m6) + (z*mat->m10 + mat->m14);
+    mat->m15 = (x*mat->m3 + y*mat->m7) + (z*mat->m11 + mat->m15);
 
-    // NOTE: We transpose matrix with multiplication order
-    *RLGL.State.currentMatrix = rlMatrixMultiply(matTranslation, *RLGL.State.currentMatrix);
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by a rotation matrix
@@ -1195,22 +1345,68 @@ void rlRotatef(float angle, float x, float y, float z)
     matRotation.m14 = 0.0f;
     matRotation.m15 = 1.0f;
 
-    // NOTE: We transpose matrix with multiplication order
-    *RLGL.State.currentMatrix = rlMatrixMultiply(matRotation, *RLGL.State.currentMatrix);
+    // NOTE: Multiplying by a rotation matrix (on the left) maps every memory row (m0, m4, m8, m12)...
+    // to R*row, with R the upper 3x3 of matRotation and the last element kept as is
+#if defined(RLGL_SIMD_SSE)
+    float *m = &RLGL.State.currentMatrix->m0;
+    __m128 r0 = _mm_set_ps(0.0f, matRotation.m8, matRotation.m4, matRotation.m0);
+    __m128 r1 = _mm_set_ps(0.0f, matRotation.m9, matRotation.m5, matRotation.m1);
+    __m128 r2 = _mm_set_ps(0.0f, matRotation.m10, matRotation.m6, matRotation.m2);
+    __m128 last = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    for (int j = 0; j < 16; j += 4)
+    {
+        __m128 row = _mm_loadu_ps(m + j);
+
+        _mm_storeu_ps(m + j, _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(r0, _mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(r1, _mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)))),
+            _mm_add_ps(_mm_mul_ps(r2, _mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2))), _mm_and_ps(row, last))));
+    }
+#elif defined(RLGL_SIMD_NEON)
+    float *m = &RLGL.State.currentMatrix->m0;
+    const float c0[4] = { matRotation.m0, matRotation.m4, matRotation.m8, 0.0f };
+    const float c1[4] = { matRotation.m1, matRotation.m5, matRotation.m9, 0.0f };
+    const float c2[4] = { matRotation.m2, matRotation.m6, matRotation.m10, 0.0f };
+    float32x4_t r0 = vld1q_f32(c0), r1 = vld1q_f32(c1), r2 = vld1q_f32(c2);
+
+    for (int j = 0; j < 16; j += 4)
+    {
+        float32x4_t row = vld1q_f32(m + j);
+
+        vst1q_f32(m + j, vaddq_f32(
+            vaddq_f32(vmulq_n_f32(r0, vgetq_lane_f32(row, 0)), vmulq_n_f32(r1, vgetq_lane_f32(row, 1))),
+            vaddq_f32(vmulq_n_f32(r2, vgetq_lane_f32(row, 2)), vsetq_lane_f32(vgetq_lane_f32(row, 3), vdupq_n_f32(0.0f), 3))));
+    }
+#else
+    rlMatrixMultiplyTo(&matRotation, RLGL.State.currentMatrix, RLGL.State.currentMatrix);
+#endif
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by a scaling matrix
 void rlScalef(float x, float y, float z)
 {
-    Matrix matScale = {
-        x, 0.0f, 0.0f, 0.0f,
-        0.0f, y, 0.0f, 0.0f,
-        0.0f, 0.0f, z, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
+    // NOTE: Multiplying by a scaling matrix (on the left) scales m0..m3 by x, m4..m7 by y and m8..m11 by z,
+    // the first three elements of every memory row (m0, m4, m8, m12)...
+#if defined(RLGL_SIMD_SSE)
+    float *m = &RLGL.State.currentMatrix->m0;
+    __m128 scale = _mm_set_ps(1.0f, z, y, x);
+
+    for (int j = 0; j < 16; j += 4) _mm_storeu_ps(m + j, _mm_mul_ps(_mm_loadu_ps(m + j), scale));
+#elif defined(RLGL_SIMD_NEON)
+    float *m = &RLGL.State.currentMatrix->m0;
+    const float s[4] = { x, y, z, 1.0f };
+    float32x4_t scale = vld1q_f32(s);
 
-    // NOTE: We transpose matrix with multiplication order
-    *RLGL.State.currentMatrix = rlMatrixMultiply(matScale, *RLGL.State.currentMatrix);
+    for (int j = 0; j < 16; j += 4) vst1q_f32(m + j, vmulq_f32(vld1q_f32(m + j), scale));
+#else
+    Matrix *mat = RLGL.State.currentMatrix;
+
+    mat->m0 *= x; mat->m1 *= x; mat->m2 *= x; mat->m3 *= x;
+    mat->m4 *= y; mat->m5 *= y; mat->m6 *= y; mat->m7 *= y;
+    mat->m8 *= z; mat->m9 *= z; mat->m10 *= z; mat->m11 *= z;
+#endif
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by another matrix
@@ -1222,7 +1418,8 @@ void rlMultMatrixf(const float *matf)
                    matf[2], matf[6], matf[10], matf[14],
                    matf[3], matf[7], matf[11], matf[15] };
 
-    *RLGL.State.currentMatrix = rlMatrixMultiply(*RLGL.State.currentMatrix, mat);
+    rlMatrixMultiplyTo(RLGL.State.currentMatrix, &mat, RLGL.State.currentMatrix);
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by a perspective matrix generated by parameters
@@ -1254,7 +1451,8 @@ void rlFrustum(double left, double right, double bottom, double top, double znea
     matFrustum.m14 = -((float)zfar*(float)znear*2.0f)/fn;
     matFrustum.m15 = 0.0f;
 
-    *RLGL.State.currentMatrix = rlMatrixMultiply(*RLGL.State.currentMatrix, matFrustum);
+    rlMatrixMultiplyTo(RLGL.State.currentMatrix, &matFrustum, RLGL.State.currentMatrix);
+    rlCurrentMatrixChanged();
 }
 
 // Multiply the current matrix by an orthographic matrix generated by parameters
@@ -1285,7 +1483,8 @@ void rlOrtho(double left, double right, double bottom, double top, double znear,
     matOrtho.m14 = -((float)zfar + (float)znear)/fn;
     matOrtho.m15 = 1.0f;
 
-    *RLGL.State.currentMatrix = rlMatrixMultiply(*RLGL.State.currentMatrix, matOrtho);
+    rlMatrixMultiplyTo(RLGL.State.currentMatrix, &matOrtho, RLGL.State.currentMatrix);
+    rlCurrentMatrixChanged();
 }
 #endif
 
@@ -1322,6 +1521,14 @@ void rlNormal3f(float x, float y, float z) { glNormal3f(x, y, z); }
 void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a) { glColor4ub(r, g, b, a); }
 void rlColor3f(float x, float y, float z) { glColor3f(x, y, z); }
 void rlColor4f(float x, float y, float z, float w) { glColor4f(x, y, z, w); }
+void rlVertexArray3f(const float *positions, const unsigned char *colors, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (colors != NULL) glColor4ub(colors[4*i], colors[4*i + 1], colors[4*i + 2], colors[4*i + 3]);
+        glVertex3f(positions[3*i], positions[3*i + 1], positions[3*i + 2]);
+    }
+}
 #endif
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
 // Initialize drawing mode (how to organize vertex)
@@ -1346,14 +1553,16 @@ void rlBegin(int mode)
             {
                 RLGL.State.vertexCounter += RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexAlignment;
                 RLGL.currentBatch->drawCounter++;
+                RLGL.currentBatch->drawsRecorded++;
             }
         }
 
-        if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlDrawRenderBatch(RLGL.currentBatch);
+        if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlCheckRenderBatchDrawLimit();
 
         RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].mode = mode;
         RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount = 0;
         RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].textureId = RLGL.State.defaultTextureId;
+        RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].layer = RLGL.State.drawLayer;
     }
 }
 
@@ -1377,9 +1586,31 @@ void rlVertex3f(float x, float y, float z)
     // Transform provided vector if required
     if (RLGL.State.transformRequired)
     {
+#if defined(RLGL_SIMD_SSE) || defined(RLGL_SIMD_NEON)
+        if (RLGL.State.transformChanged) rlUpdateTransformColumns();
+#endif
+#if defined(RLGL_SIMD_SSE)
+        // Transposed transform, so this is column0*x + column1*y + column2*z + column3
+        const float *columns = RLGL.State.transformColumns;
+        __m128 t = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(columns), _mm_set1_ps(x)),
+            _mm_mul_ps(_mm_loadu_ps(columns + 4), _mm_set1_ps(y))), _mm_mul_ps(_mm_loadu_ps(columns + 8), _mm_set1_ps(z))), _mm_loadu_ps(columns + 12));
+
+        tx = _mm_cvtss_f32(t);
+        ty = _mm_cvtss_f32(_mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+        tz = _mm_cvtss_f32(_mm_movehl_ps(t, t));
+#elif defined(RLGL_SIMD_NEON)
+        const float *columns = RLGL.State.transformColumns;
+        float32x4_t t = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(columns), x),
+            vmulq_n_f32(vld1q_f32(columns + 4), y)), vmulq_n_f32(vld1q_f32(columns + 8), z)), vld1q_f32(columns + 12));
+
+        tx = vgetq_lane_f32(t, 0);
+        ty = vgetq_lane_f32(t, 1);
+        tz = vgetq_lane_f32(t, 2);
+#else
         tx = RLGL.State.transform.m0*x + RLGL.State.transform.m4*y + RLGL.State.transform.m8*z + RLGL.State.transform.m12;
         ty = RLGL.State.transform.m1*x + RLGL.State.transform.m5*y + RLGL.State.transform.m9*z + RLGL.State.transform.m13;
         tz = RLGL.State.transform.m2*x + RLGL.State.transform.m6*y + RLGL.State.transform.m10*z + RLGL.State.transform.m14;
+#endif
     }
 
     // WARNING: We can't break primitives when launching a new batch.
@@ -1407,6 +1638,25 @@ void rlVertex3f(float x, float y, float z)
         }
     }
 
+    if (RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].interleaved != NULL)
+    {
+        // Add vertex position, current texcoord and current color, all next to each other
+        rlVertex *vertex = &RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].interleaved[RLGL.State.vertexCounter];
+        vertex->position[0] = tx;
+        vertex->position[1] = ty;
+        vertex->position[2] = tz;
+        vertex->texcoord[0] = RLGL.State.texcoordx;
+        vertex->texcoord[1] = RLGL.State.texcoordy;
+        vertex->color[0] = RLGL.State.colorr;
+        vertex->color[1] = RLGL.State.colorg;
+        vertex->color[2] = RLGL.State.colorb;
+        vertex->color[3] = RLGL.State.colora;
+
+        RLGL.State.vertexCounter++;
+        RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount++;
+        return;
+    }
+
     // Add vertices
     RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].vertices[3*RLGL.State.vertexCounter] = tx;
     RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].vertices[3*RLGL.State.vertexCounter + 1] = ty;
@@ -1429,6 +1679,188 @@ void rlVertex3f(float x, float y, float z)
     RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount++;
 }
 
+// Transform XYZ positions by matrix, in the same operation order as rlVertex3f()
+// NOTE: SIMD paths load 4 (SSE) or 8 (AVX) interleaved positions, transpose them
+// to XXXX/YYYY/ZZZZ, transform and transpose back, the remainder is done scalar
+static void rlTransformPositions(const float *in, float *out, int count, Matrix mat)
+{
+    int i = 0;
+
+#if defined(RLGL_SIMD_AVX)
+    {
+        __m256 m0 = _mm256_set1_ps(mat.m0), m4 = _mm256_set1_ps(mat.m4), m8 = _mm256_set1_ps(mat.m8), m12 = _mm256_set1_ps(mat.m12);
+        __m256 m1 = _mm256_set1_ps(mat.m1), m5 = _mm256_set1_ps(mat.m5), m9 = _mm256_set1_ps(mat.m9), m13 = _mm256_set1_ps(mat.m13);
+        __m256 m2 = _mm256_set1_ps(mat.m2), m6 = _mm256_set1_ps(mat.m6), m10 = _mm256_set1_ps(mat.m10), m14 = _mm256_set1_ps(mat.m14);
+
+        for (; i + 8 <= count; i += 8)
+        {
+            const float *p = in + 3*i;
+
+            // Low 128bit lane holds positions 0..3, high lane positions 4..7
+            __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 12), 1);
+            __m256 b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+            __m256 c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+
+            __m256 x = _mm256_shuffle_ps(_mm256_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 0)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+            __m256 y = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm256_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 z = _mm256_shuffle_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm256_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            __m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m4, y)), _mm256_mul_ps(m8, z)), m12);
+            __m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, x), _mm256_mul_ps(m5, y)), _mm256_mul_ps(m9, z)), m13);
+            __m256 tz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, x), _mm256_mul_ps(m6, y)), _mm256_mul_ps(m10, z)), m14);
+
+            a = _mm256_shuffle_ps(_mm256_shuffle_ps(tx, ty, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_shuffle_ps(tz, tx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            b = _mm256_shuffle_ps(_mm256_shuffle_ps(ty, tz, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_shuffle_ps(tx, ty, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+            c = _mm256_shuffle_ps(_mm256_shuffle_ps(tz, tx, _MM_SHUFFLE(3, 3, 2, 2)), _mm256_shuffle_ps(ty, tz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            float *q = out + 3*i;
+            _mm_storeu_ps(q, _mm256_castps256_ps128(a));
+            _mm_storeu_ps(q + 4, _mm256_castps256_ps128(b));
+            _mm_storeu_ps(q + 8, _mm256_castps256_ps128(c));
+            _mm_storeu_ps(q + 12, _mm256_extractf128_ps(a, 1));
+            _mm_storeu_ps(q + 16, _mm256_extractf128_ps(b, 1));
+            _mm_storeu_ps(q + 20, _mm256_extractf128_ps(c, 1));
+        }
+    }
+#endif
+
+#if defined(RLGL_SIMD_SSE)
+    {
+        __m128 m0 = _mm_set1_ps(mat.m0), m4 = _mm_set1_ps(mat.m4), m8 = _mm_set1_ps(mat.m8), m12 = _mm_set1_ps(mat.m12);
+        __m128 m1 = _mm_set1_ps(mat.m1), m5 = _mm_set1_ps(mat.m5), m9 = _mm_set1_ps(mat.m9), m13 = _mm_set1_ps(mat.m13);
+        __m128 m2 = _mm_set1_ps(mat.m2), m6 = _mm_set1_ps(mat.m6), m10 = _mm_set1_ps(mat.m10), m14 = _mm_set1_ps(mat.m14);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const float *p = in + 3*i;
+
+            // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+            __m128 a = _mm_loadu_ps(p);
+            __m128 b = _mm_loadu_ps(p + 4);
+            __m128 c = _mm_loadu_ps(p + 8);
+
+            __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+            __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+            __m128 tx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_mul_ps(m8, z)), m12);
+            __m128 ty = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_mul_ps(m9, z)), m13);
+            __m128 tz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_mul_ps(m10, z)), m14);
+
+            float *q = out + 3*i;
+            _mm_storeu_ps(q, _mm_shuffle_ps(_mm_shuffle_ps(tx, ty, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(tz, tx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(q + 4, _mm_shuffle_ps(_mm_shuffle_ps(ty, tz, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(tx, ty, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(q + 8, _mm_shuffle_ps(_mm_shuffle_ps(tz, tx, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(ty, tz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+#endif
+
+#if defined(RLGL_SIMD_NEON)
+    // NEON de-interleaves XYZ on load and re-interleaves on store, no shuffling required
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4x3_t p = vld3q_f32(in + 3*i);
+        float32x4x3_t t;
+
+        t.val[0] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], mat.m0), vmulq_n_f32(p.val[1], mat.m4)), vmulq_n_f32(p.val[2], mat.m8)), vdupq_n_f32(mat.m12));
+        t.val[1] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], mat.m1), vmulq_n_f32(p.val[1], mat.m5)), vmulq_n_f32(p.val[2], mat.m9)), vdupq_n_f32(mat.m13));
+        t.val[2] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_n_f32(p.val[0], mat.m2), vmulq_n_f32(p.val[1], mat.m6)), vmulq_n_f32(p.val[2], mat.m10)), vdupq_n_f32(mat.m14));
+
+        vst3q_f32(out + 3*i, t);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float x = in[3*i];
+        float y = in[3*i + 1];
+        float z = in[3*i + 2];
+
+        out[3*i] = mat.m0*x + mat.m4*y + mat.m8*z + mat.m12;
+        out[3*i + 1] = mat.m1*x + mat.m5*y + mat.m9*z + mat.m13;
+        out[3*i + 2] = mat.m2*x + mat.m6*y + mat.m10*z + mat.m14;
+    }
+}
+
+// Define many vertices at once: positions (XYZ) and colors (RGBA, NULL to use current color)
+// NOTE: Equivalent to rlColor4ub() + rlVertex3f() per vertex, but vertices are transformed in bulk
+// and copied straight into the current vertex buffer, splitting only at whole primitives when it fills up
+void rlVertexArray3f(const float *positions, const unsigned char *colors, int count)
+{
+    int mode = RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].mode;
+    int primitive = (mode == RL_LINES)? 2 : ((mode == RL_TRIANGLES)? 3 : 4);
+
+    while (count > 0)
+    {
+        rlVertexBuffer *buffer = &RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer];
+
+        // Same limit as rlCheckRenderBatchLimit(): vertexCounter must stay below elementCount*4
+        int room = buffer->elementCount*4 - RLGL.State.vertexCounter - 1;
+        int n = (count < room)? count : (room/primitive)*primitive;
+
+        if (n <= 0)
+        {
+            rlCheckRenderBatchLimit(primitive);
+            continue;
+        }
+
+        int first = RLGL.State.vertexCounter;
+
+        if (buffer->interleaved != NULL)
+        {
+            // Transform a few vertex at a time into a scratch array, then interleave them
+            float transformed[3*64];
+            unsigned char color[4] = { RLGL.State.colorr, RLGL.State.colorg, RLGL.State.colorb, RLGL.State.colora };
+
+            for (int k = 0; k < n; k += 64)
+            {
+                int m = ((n - k) < 64)? (n - k) : 64;
+                const float *source = positions + 3*k;
+
+                if (RLGL.State.transformRequired)
+                {
+                    rlTransformPositions(source, transformed, m, RLGL.State.transform);
+                    source = transformed;
+                }
+
+                for (int j = 0; j < m; j++)
+                {
+                    rlVertex *vertex = &buffer->interleaved[first + k + j];
+                    memcpy(vertex->position, source + 3*j, 3*sizeof(float));
+                    vertex->texcoord[0] = RLGL.State.texcoordx;
+                    vertex->texcoord[1] = RLGL.State.texcoordy;
+                    memcpy(vertex->color, (colors != NULL)? colors + 4*(k + j) : color, 4);
+                }
+            }
+        }
+        else
+        {
+            if (RLGL.State.transformRequired) rlTransformPositions(positions, buffer->vertices + 3*first, n, RLGL.State.transform);
+            else memcpy(buffer->vertices + 3*first, positions, n*3*sizeof(float));
+
+            for (int i = first; i < first + n; i++)
+            {
+                buffer->texcoords[2*i] = RLGL.State.texcoordx;
+                buffer->texcoords[2*i + 1] = RLGL.State.texcoordy;
+            }
+
+            if (colors != NULL) memcpy(buffer->colors + 4*first, colors, n*4*sizeof(unsigned char));
+            else
+            {
+                unsigned char color[4] = { RLGL.State.colorr, RLGL.State.colorg, RLGL.State.colorb, RLGL.State.colora };
+                for (int i = first; i < first + n; i++) memcpy(buffer->colors + 4*i, color, 4);
+            }
+        }
+
+        RLGL.State.vertexCounter += n;
+        RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount += n;
+
+        positions += 3*n;
+        if (colors != NULL) colors += 4*n;
+        count -= n;
+    }
+}
+
 // Define one vertex (position)
 void rlVertex2f(float x, float y)
 {
@@ -1445,8 +1877,8 @@ void rlVertex2i(int x, int y)
 // NOTE: Texture coordinates are limited to QUADS only
 void rlTexCoord2f(float x, float y)
 {
-    RLGL.State.texcoordx = x;
-    RLGL.State.texcoordy = y;
+    RLGL.State.texcoordx = RLGL.State.texcoordRegion[0] + x*RLGL.State.texcoordRegion[2];
+    RLGL.State.texcoordy = RLGL.State.texcoordRegion[1] + y*RLGL.State.texcoordRegion[3];
 }
 
 // Define one vertex (normal)
@@ -1488,6 +1920,23 @@ void rlColor3f(float x, float y, float z)
 // Set current texture to use
 void rlSetTexture(unsigned int id)
 {
+#if defined(GRAPHICS_API_OPENGL_11)
+    // Only undo a texture region, any texture matrix set by the user is kept
+    if (textureRegionPushed)
+    {
+        glPushAttrib(GL_TRANSFORM_BIT);
+        glMatrixMode(GL_TEXTURE);
+        glPopMatrix();
+        glPopAttrib();
+        textureRegionPushed = false;
+    }
+#else
+    RLGL.State.texcoordRegion[0] = 0.0f;
+    RLGL.State.texcoordRegion[1] = 0.0f;
+    RLGL.State.texcoordRegion[2] = 1.0f;
+    RLGL.State.texcoordRegion[3] = 1.0f;
+#endif
+
     if (id == 0)
     {
 #if defined(GRAPHICS_API_OPENGL_11)
@@ -1497,6 +1946,7 @@ void rlSetTexture(unsigned int id)
         if (RLGL.State.vertexCounter >=
             RLGL.currentBatch->vertexBuffer[RLGL.currentBatch->currentBuffer].elementCount*4)
         {
+            RLGL.State.flushCause = RL_FLUSH_BUFFER_FULL;
             rlDrawRenderBatch(RLGL.currentBatch);
         }
 #endif
@@ -1524,18 +1974,90 @@ void rlSetTexture(unsigned int id)
                     RLGL.State.vertexCounter += RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexAlignment;
 
                     RLGL.currentBatch->drawCounter++;
+                    RLGL.currentBatch->drawsRecorded++;
                 }
             }
 
-            if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlDrawRenderBatch(RLGL.currentBatch);
+            if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlCheckRenderBatchDrawLimit();
 
             RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].textureId = id;
             RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].vertexCount = 0;
+            RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].layer = RLGL.State.drawLayer;
         }
 #endif
     }
 }
 
+// Set current texture, mapping rlTexCoord2f() [0..1] to a region of it (until next rlSetTexture())
+// NOTE: Used to draw images packed in a texture atlas with their own texture coordinates
+void rlSetTextureRegion(unsigned int id, float u0, float v0, float u1, float v1)
+{
+    rlSetTexture(id);
+
+#if defined(GRAPHICS_API_OPENGL_11)
+    glPushAttrib(GL_TRANSFORM_BIT);
+    glMatrixMode(GL_TEXTURE);
+    glPushMatrix();
+    glLoadIdentity();
+    glTranslatef(u0, v0, 0.0f);
+    glScalef(u1 - u0, v1 - v0, 1.0f);
+    glPopAttrib();
+    textureRegionPushed = true;
+#else
+    RLGL.State.texcoordRegion[0] = u0;
+    RLGL.State.texcoordRegion[1] = v0;
+    RLGL.State.texcoordRegion[2] = u1 - u0;
+    RLGL.State.texcoordRegion[3] = v1 - v0;
+#endif
+}
+
+// Set current draw layer
+// NOTE: Only deferred batches use it, their draws are sorted by layer first and then grouped by
+// texture and mode, so overlapping draws that must keep their order need different layers,
+// non-deferred batches always draw in submission order
+// NOTE: Layers are clamped to 16 bits, the sort key needs the other 48 for texture and mode
+void rlSetDrawLayer(int layer)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if (layer < -32768) layer = -32768;
+    else if (layer > 32767) layer = 32767;
+
+    RLGL.State.drawLayer = layer;
+
+    rlDrawCall *draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+
+    if (RLGL.currentBatch->deferred && (draw->layer != layer))
+    {
+        if (draw->vertexCount > 0)
+        {
+            // Same alignment as a texture change, see rlSetTexture()
+            if (draw->mode == RL_LINES) draw->vertexAlignment = ((draw->vertexCount < 4)? draw->vertexCount : draw->vertexCount%4);
+            else if (draw->mode == RL_TRIANGLES) draw->vertexAlignment = ((draw->vertexCount < 4)? 1 : (4 - (draw->vertexCount%4)));
+            else draw->vertexAlignment = 0;
+
+            int mode = draw->mode;
+            unsigned int textureId = draw->textureId;
+
+            if (!rlCheckRenderBatchLimit(draw->vertexAlignment))
+            {
+                RLGL.State.vertexCounter += draw->vertexAlignment;
+                RLGL.currentBatch->drawCounter++;
+                RLGL.currentBatch->drawsRecorded++;
+            }
+
+            if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS) rlCheckRenderBatchDrawLimit();
+
+            draw = &RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1];
+            draw->mode = mode;
+            draw->textureId = textureId;
+            draw->vertexCount = 0;
+        }
+
+        draw->layer = layer;
+    }
+#endif
+}
+
 // Select and active a texture slot
 void rlActiveTextureSlot(int slot)
 {
@@ -1903,6 +2425,7 @@ void rlSetBlendMode(int mode)
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
     if ((RLGL.State.currentBlendMode != mode) || ((mode == RL_BLEND_CUSTOM || mode == RL_BLEND_CUSTOM_SEPARATE) && RLGL.State.glCustomBlendModeModified))
     {
+        RLGL.State.flushCause = RL_FLUSH_STATE_CHANGE;
         rlDrawRenderBatch(RLGL.currentBatch);
 
         switch (mode)
@@ -2080,9 +2603,14 @@ void rlglInit(int width, int height)
 
     // Init internal matrices
     RLGL.State.transform = rlMatrixIdentity();
+    RLGL.State.transformChanged = true;
     RLGL.State.projection = rlMatrixIdentity();
     RLGL.State.modelview = rlMatrixIdentity();
     RLGL.State.currentMatrix = &RLGL.State.modelview;
+
+    // Init texture region, full texture
+    RLGL.State.texcoordRegion[2] = 1.0f;
+    RLGL.State.texcoordRegion[3] = 1.0f;
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
     // Initialize OpenGL default states
@@ -2474,6 +3002,18 @@ int *rlGetShaderLocsDefault(void)
 //------------------------------------------------------------------------------------------------
 // Load render batch
 rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements)
+{
+    return rlLoadRenderBatchLayout(numBuffers, bufferElements, false);
+}
+
+// Load render batch, with interleaved vertex data
+rlRenderBatch rlLoadRenderBatchInterleaved(int numBuffers, int bufferElements)
+{
+    return rlLoadRenderBatchLayout(numBuffers, bufferElements, true);
+}
+
+// Load render batch, with separate or interleaved vertex data
+static rlRenderBatch rlLoadRenderBatchLayout(int numBuffers, int bufferElements, bool interleaved)
 {
     rlRenderBatch batch = { 0 };
 
@@ -2485,10 +3025,25 @@ rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements)
     for (int i = 0; i < numBuffers; i++)
     {
         batch.vertexBuffer[i].elementCount = bufferElements;
+        batch.vertexBuffer[i].vertices = NULL;
+        batch.vertexBuffer[i].texcoords = NULL;
+        batch.vertexBuffer[i].colors = NULL;
+        batch.vertexBuffer[i].interleaved = NULL;
+
+        if (interleaved)
+        {
+            batch.vertexBuffer[i].interleaved = (rlVertex *)RL_CALLOC(bufferElements*4, sizeof(rlVertex));    // 4 vertex by quad
+        }
+        else
+        {
+            batch.vertexBuffer[i].vertices = (float *)RL_MALLOC(bufferElements*3*4*sizeof(float));        // 3 float by vertex, 4 vertex by quad
+            batch.vertexBuffer[i].texcoords = (float *)RL_MALLOC(bufferElements*2*4*sizeof(float));       // 2 float by texcoord, 4 texcoord by quad
+            batch.vertexBuffer[i].colors = (unsigned char *)RL_MALLOC(bufferElements*4*4*sizeof(unsigned char));   // 4 float by color, 4 colors by quad
 
-        batch.vertexBuffer[i].vertices = (float *)RL_MALLOC(bufferElements*3*4*sizeof(float));        // 3 float by vertex, 4 vertex by quad
-        batch.vertexBuffer[i].texcoords = (float *)RL_MALLOC(bufferElements*2*4*sizeof(float));       // 2 float by texcoord, 4 texcoord by quad
-        batch.vertexBuffer[i].colors = (unsigned char *)RL_MALLOC(bufferElements*4*4*sizeof(unsigned char));   // 4 float by color, 4 colors by quad
+            for (int j = 0; j < (3*4*bufferElements); j++) batch.vertexBuffer[i].vertices[j] = 0.0f;
+            for (int j = 0; j < (2*4*bufferElements); j++) batch.vertexBuffer[i].texcoords[j] = 0.0f;
+            for (int j = 0; j < (4*4*bufferElements); j++) batch.vertexBuffer[i].colors[j] = 0;
+        }
 #if defined(GRAPHICS_API_OPENGL_33)
         batch.vertexBuffer[i].indices = (unsigned int *)RL_MALLOC(bufferElements*6*sizeof(unsigned int));      // 6 int by quad (indices)
 #endif
@@ -2496,10 +3051,6 @@ rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements)
         batch.vertexBuffer[i].indices = (unsigned short *)RL_MALLOC(bufferElements*6*sizeof(unsigned short));  // 6 int by quad (indices)
 #endif
 
-        for (int j = 0; j < (3*4*bufferElements); j++) batch.vertexBuffer[i].vertices[j] = 0.0f;
-        for (int j = 0; j < (2*4*bufferElements); j++) batch.vertexBuffer[i].texcoords[j] = 0.0f;
-        for (int j = 0; j < (4*4*bufferElements); j++) batch.vertexBuffer[i].colors[j] = 0;
-
         int k = 0;
 
         // Indices can be initialized right now
@@ -2532,27 +3083,42 @@ rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements)
             glBindVertexArray(batch.vertexBuffer[i].vaoId);
         }
 
-        // Quads - Vertex buffers binding and attributes enable
-        // Vertex position buffer (shader-location = 0)
-        glGenBuffers(1, &batch.vertexBuffer[i].vboId[0]);
-        glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[0]);
-        glBufferData(GL_ARRAY_BUFFER, bufferElements*3*4*sizeof(float), batch.vertexBuffer[i].vertices, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION]);
-        glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION], 3, GL_FLOAT, 0, 0, 0);
-
-        // Vertex texcoord buffer (shader-location = 1)
-        glGenBuffers(1, &batch.vertexBuffer[i].vboId[1]);
-        glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[1]);
-        glBufferData(GL_ARRAY_BUFFER, bufferElements*2*4*sizeof(float), batch.vertexBuffer[i].texcoords, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
-        glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, GL_FLOAT, 0, 0, 0);
-
-        // Vertex color buffer (shader-location = 3)
-        glGenBuffers(1, &batch.vertexBuffer[i].vboId[2]);
-        glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[2]);
-        glBufferData(GL_ARRAY_BUFFER, bufferElements*4*4*sizeof(unsigned char), batch.vertexBuffer[i].colors, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR]);
-        glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR], 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+        batch.vertexBuffer[i].vboId[1] = 0;
+        batch.vertexBuffer[i].vboId[2] = 0;
+        batch.vertexBuffer[i].fence = NULL;
+
+        if (interleaved)
+        {
+            // Quads - Single vertex buffer, all attributes sourced from it with a stride of sizeof(rlVertex)
+            glGenBuffers(1, &batch.vertexBuffer[i].vboId[0]);
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[0]);
+            glBufferData(GL_ARRAY_BUFFER, bufferElements*4*sizeof(rlVertex), batch.vertexBuffer[i].interleaved, GL_DYNAMIC_DRAW);
+            rlSetVertexAttributesInterleaved();
+        }
+        else
+        {
+            // Quads - Vertex buffers binding and attributes enable
+            // Vertex position buffer (shader-location = 0)
+            glGenBuffers(1, &batch.vertexBuffer[i].vboId[0]);
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[0]);
+            glBufferData(GL_ARRAY_BUFFER, bufferElements*3*4*sizeof(float), batch.vertexBuffer[i].vertices, GL_DYNAMIC_DRAW);
+            glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION]);
+            glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION], 3, GL_FLOAT, 0, 0, 0);
+
+            // Vertex texcoord buffer (shader-location = 1)
+            glGenBuffers(1, &batch.vertexBuffer[i].vboId[1]);
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[1]);
+            glBufferData(GL_ARRAY_BUFFER, bufferElements*2*4*sizeof(float), batch.vertexBuffer[i].texcoords, GL_DYNAMIC_DRAW);
+            glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
+            glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, GL_FLOAT, 0, 0, 0);
+
+            // Vertex color buffer (shader-location = 3)
+            glGenBuffers(1, &batch.vertexBuffer[i].vboId[2]);
+            glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer[i].vboId[2]);
+            glBufferData(GL_ARRAY_BUFFER, bufferElements*4*4*sizeof(unsigned char), batch.vertexBuffer[i].colors, GL_DYNAMIC_DRAW);
+            glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR]);
+            glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR], 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+        }
 
         // Fill index buffer
         glGenBuffers(1, &batch.vertexBuffer[i].vboId[3]);
@@ -2583,6 +3149,7 @@ rlRenderBatch rlLoadRenderBatch(int numBuffers, int bufferElements)
         //batch.draws[i].vaoId = 0;
         //batch.draws[i].shaderId = 0;
         batch.draws[i].textureId = RLGL.State.defaultTextureId;
+        batch.draws[i].layer = 0;
         //batch.draws[i].RLGL.State.projection = rlMatrixIdentity();
         //batch.draws[i].RLGL.State.modelview = rlMatrixIdentity();
     }
@@ -2619,6 +3186,7 @@ void rlUnloadRenderBatch(rlRenderBatch batch)
         }
 
         // Delete VBOs from GPU (VRAM)
+        // NOTE: Interleaved buffers only use vboId[0] and vboId[3], deleting id 0 is silently ignored
         glDeleteBuffers(1, &batch.vertexBuffer[i].vboId[0]);
         glDeleteBuffers(1, &batch.vertexBuffer[i].vboId[1]);
         glDeleteBuffers(1, &batch.vertexBuffer[i].vboId[2]);
@@ -2627,16 +3195,22 @@ void rlUnloadRenderBatch(rlRenderBatch batch)
         // Delete VAOs from GPU (VRAM)
         if (RLGL.ExtSupported.vao) glDeleteVertexArrays(1, &batch.vertexBuffer[i].vaoId);
 
+#if defined(GRAPHICS_API_OPENGL_33)
+        if (batch.vertexBuffer[i].fence != NULL) glDeleteSync((GLsync)batch.vertexBuffer[i].fence);
+#endif
+
         // Free vertex arrays memory from CPU (RAM)
         RL_FREE(batch.vertexBuffer[i].vertices);
         RL_FREE(batch.vertexBuffer[i].texcoords);
         RL_FREE(batch.vertexBuffer[i].colors);
+        RL_FREE(batch.vertexBuffer[i].interleaved);
         RL_FREE(batch.vertexBuffer[i].indices);
     }
 
     // Unload arrays
     RL_FREE(batch.vertexBuffer);
     RL_FREE(batch.draws);
+    RL_FREE(batch.sortScratch);
 #endif
 }
 
@@ -2645,29 +3219,64 @@ void rlUnloadRenderBatch(rlRenderBatch batch)
 void rlDrawRenderBatch(rlRenderBatch *batch)
 {
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    double startTime = rlGetClock();
+    int flushCause = RLGL.State.flushCause;
+    RLGL.State.flushCause = RL_FLUSH_EXPLICIT;
+
     // Update batch vertex buffers
     //------------------------------------------------------------------------------------------------------------
     // NOTE: If there is not vertex data, buffers doesn't need to be updated (vertexCount > 0)
     // TODO: If no data changed on the CPU arrays --> No need to re-update GPU arrays (change flag required)
+    // NOTE: Sorting closes and counts the last draw, leaving an empty one
+    if (batch->deferred) rlSortRenderBatch(batch);
+    if (batch->draws[batch->drawCounter - 1].vertexCount > 0) batch->drawsRecorded++;
+
     if (RLGL.State.vertexCounter > 0)
     {
-        // Activate elements VAO
-        if (RLGL.ExtSupported.vao) glBindVertexArray(batch->vertexBuffer[batch->currentBuffer].vaoId);
+#if defined(GRAPHICS_API_OPENGL_33)
+        // Make sure the GPU is done drawing from this buffer before overwriting it,
+        // with multiple buffers it usually is, and the wait below never happens
+        if (batch->vertexBuffer[batch->currentBuffer].fence != NULL)
+        {
+            GLsync fence = (GLsync)batch->vertexBuffer[batch->currentBuffer].fence;
 
-        // Vertex positions buffer
-        glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[0]);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*3*sizeof(float), batch->vertexBuffer[batch->currentBuffer].vertices);
-        //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].vertices, GL_DYNAMIC_DRAW);  // Update all buffer
+            if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            {
+                batch->fenceWaits++;
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, RL_BATCH_FENCE_TIMEOUT);
+            }
+
+            glDeleteSync(fence);
+            batch->vertexBuffer[batch->currentBuffer].fence = NULL;
+        }
+#endif
 
-        // Texture coordinates buffer
-        glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[1]);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*2*sizeof(float), batch->vertexBuffer[batch->currentBuffer].texcoords);
-        //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].texcoords, GL_DYNAMIC_DRAW); // Update all buffer
+        // Activate elements VAO
+        if (RLGL.ExtSupported.vao) glBindVertexArray(batch->vertexBuffer[batch->currentBuffer].vaoId);
 
-        // Colors buffer
-        glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[2]);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*4*sizeof(unsigned char), batch->vertexBuffer[batch->currentBuffer].colors);
-        //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*4*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].colors, GL_DYNAMIC_DRAW);    // Update all buffer
+        if (batch->vertexBuffer[batch->currentBuffer].interleaved != NULL)
+        {
+            // Interleaved vertex buffer, all vertex data in a single upload
+            glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[0]);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*sizeof(rlVertex), batch->vertexBuffer[batch->currentBuffer].interleaved);
+        }
+        else
+        {
+            // Vertex positions buffer
+            glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[0]);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*3*sizeof(float), batch->vertexBuffer[batch->currentBuffer].vertices);
+            //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*3*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].vertices, GL_DYNAMIC_DRAW);  // Update all buffer
+
+            // Texture coordinates buffer
+            glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[1]);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*2*sizeof(float), batch->vertexBuffer[batch->currentBuffer].texcoords);
+            //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*2*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].texcoords, GL_DYNAMIC_DRAW); // Update all buffer
+
+            // Colors buffer
+            glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[2]);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, RLGL.State.vertexCounter*4*sizeof(unsigned char), batch->vertexBuffer[batch->currentBuffer].colors);
+            //glBufferData(GL_ARRAY_BUFFER, sizeof(float)*4*4*batch->vertexBuffer[batch->currentBuffer].elementCount, batch->vertexBuffer[batch->currentBuffer].colors, GL_DYNAMIC_DRAW);    // Update all buffer
+        }
 
         // NOTE: glMapBuffer() causes sync issue.
         // If GPU is working with this buffer, glMapBuffer() will wait(stall) until GPU to finish its job.
@@ -2727,6 +3336,14 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
             glUniformMatrix4fv(RLGL.State.currentShaderLocs[RL_SHADER_LOC_MATRIX_MVP], 1, false, matMVPfloat);
 
             if (RLGL.ExtSupported.vao) glBindVertexArray(batch->vertexBuffer[batch->currentBuffer].vaoId);
+            else if (batch->vertexBuffer[batch->currentBuffer].interleaved != NULL)
+            {
+                // Bind vertex attribs: position, texcoord and color from the interleaved buffer
+                glBindBuffer(GL_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[0]);
+                rlSetVertexAttributesInterleaved();
+
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch->vertexBuffer[batch->currentBuffer].vboId[3]);
+            }
             else
             {
                 // Bind vertex attrib: position (shader-location = 0)
@@ -2771,6 +3388,9 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
                 // Bind current draw call texture, activated as GL_TEXTURE0 and Bound to sampler2D texture0 by default
                 glBindTexture(GL_TEXTURE_2D, batch->draws[i].textureId);
 
+                if ((eye == 0) && (batch->draws[i].vertexCount > 0)) batch->drawsIssued++;
+                if (batch->draws[i].vertexCount > 0) RLGL.batchStats.drawCalls++;
+
                 if ((batch->draws[i].mode == RL_LINES) || (batch->draws[i].mode == RL_TRIANGLES)) glDrawArrays(batch->draws[i].mode, vertexOffset, batch->draws[i].vertexCount);
                 else
                 {
@@ -2804,6 +3424,23 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
 
     // Restore viewport to default measures
     if (eyeCount == 2) rlViewport(0, 0, RLGL.State.framebufferWidth, RLGL.State.framebufferHeight);
+
+#if defined(GRAPHICS_API_OPENGL_33)
+    // Mark the point after the last draw from this buffer, it can be reused once the GPU gets past it
+    // NOTE: A single buffer is reused right away, waiting there would only stall on the draw just
+    // submitted, while without a fence the driver can rename the buffer storage and carry on
+    if ((batch->bufferCount > 1) && (RLGL.State.vertexCounter > 0)) batch->vertexBuffer[batch->currentBuffer].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+    //------------------------------------------------------------------------------------------------------------
+
+    // Update batch statistics
+    //------------------------------------------------------------------------------------------------------------
+    if (RLGL.State.vertexCounter > 0)
+    {
+        RLGL.batchStats.flushes[flushCause]++;
+        RLGL.batchStats.vertices += RLGL.State.vertexCounter;
+        if (RLGL.State.vertexCounter > RLGL.batchStats.maxVertices) RLGL.batchStats.maxVertices = RLGL.State.vertexCounter;
+    }
     //------------------------------------------------------------------------------------------------------------
 
     // Reset batch buffers
@@ -2824,6 +3461,7 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
         batch->draws[i].mode = RL_QUADS;
         batch->draws[i].vertexCount = 0;
         batch->draws[i].textureId = RLGL.State.defaultTextureId;
+        batch->draws[i].layer = RLGL.State.drawLayer;
     }
 
     // Reset active texture units for next batch
@@ -2836,6 +3474,10 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
     // Change to next buffer in the list (in case of multi-buffering)
     batch->currentBuffer++;
     if (batch->currentBuffer >= batch->bufferCount) batch->currentBuffer = 0;
+
+    double drawTime = rlGetClock() - startTime;
+    RLGL.batchStats.drawTime += drawTime;
+    if (drawTime > RLGL.batchStats.maxDrawTime) RLGL.batchStats.maxDrawTime = drawTime;
 #endif
 }
 
@@ -2843,6 +3485,7 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
 void rlSetRenderBatchActive(rlRenderBatch *batch)
 {
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    RLGL.State.flushCause = RL_FLUSH_STATE_CHANGE;
     rlDrawRenderBatch(RLGL.currentBatch);
 
     if (batch != NULL) RLGL.currentBatch = batch;
@@ -2874,6 +3517,7 @@ bool rlCheckRenderBatchLimit(int vCount)
         int currentMode = RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].mode;
         int currentTexture = RLGL.currentBatch->draws[RLGL.currentBatch->drawCounter - 1].textureId;
 
+        RLGL.State.flushCause = RL_FLUSH_BUFFER_FULL;
         rlDrawRenderBatch(RLGL.currentBatch);    // NOTE: Stereo rendering is checked inside
 
         // Restore state of last batch so we can continue adding vertices
@@ -2885,59 +3529,257 @@ bool rlCheckRenderBatchLimit(int vCount)
     return overflow;
 }
 
-// Textures data management
-//-----------------------------------------------------------------------------------------
-// Convert image data to OpenGL texture (returns OpenGL valid Id)
-unsigned int rlLoadTexture(const void *data, int width, int height, int format, int mipmapCount)
+// Sort render batch draws and merge the ones that can be drawn together
+// NOTE: Draws are ordered by a key made of layer, texture and mode, with a stable radix sort,
+// so draws with the same key keep their submission order. Vertex data is moved to match,
+// and consecutive draws with the same key become a single draw. Shader changes already
+// draw the batch (rlSetShader()), so all draws in a batch share the same shader
+// NOTE: A batch that is already sorted and merged is left as it is, so sorting before
+// rlDrawRenderBatch() does not make it sort a second time
+// WARNING: Like rlDrawRenderBatch(), batch must be the active one (vertex counter is shared)
+void rlSortRenderBatch(rlRenderBatch *batch)
 {
-    unsigned int id = 0;
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    int drawCount = batch->drawCounter;
+    rlDrawCall last = batch->draws[drawCount - 1];
 
-    glBindTexture(GL_TEXTURE_2D, 0);    // Free any old binding
+    // Sorting closes the last draw, a full batch has no room to open another one
+    if ((last.vertexCount > 0) && (drawCount >= RL_DEFAULT_BATCH_DRAWCALLS)) return;
 
-    // Check texture format support by OpenGL 1.1 (compressed textures not supported)
-#if defined(GRAPHICS_API_OPENGL_11)
-    if (format >= RL_PIXELFORMAT_COMPRESSED_DXT1_RGB)
+    unsigned long long keys[RL_DEFAULT_BATCH_DRAWCALLS] = { 0 };
+    unsigned long long sortedKeys[RL_DEFAULT_BATCH_DRAWCALLS] = { 0 };
+    int offsets[RL_DEFAULT_BATCH_DRAWCALLS] = { 0 };
+    int order[RL_DEFAULT_BATCH_DRAWCALLS] = { 0 };
+    int sortedOrder[RL_DEFAULT_BATCH_DRAWCALLS] = { 0 };
+    int count = 0;
+
+    // Collect non-empty draws, key: layer (16 bits, biased to sort negative layers first) | texture (32 bits) | mode (16 bits)
+    for (int i = 0, vertexOffset = 0; i < drawCount; i++)
     {
-        TRACELOG(RL_LOG_WARNING, "GL: OpenGL 1.1 does not support GPU compressed texture formats");
-        return id;
+        if (batch->draws[i].vertexCount > 0)
+        {
+            keys[count] = ((unsigned long long)(((unsigned int)batch->draws[i].layer ^ 0x8000u) & 0xffff) << 48) |
+                          ((unsigned long long)batch->draws[i].textureId << 16) |
+                          (unsigned long long)(batch->draws[i].mode & 0xffff);
+            offsets[i] = vertexOffset;
+            order[count] = i;
+            count++;
+        }
+
+        vertexOffset += (batch->draws[i].vertexCount + batch->draws[i].vertexAlignment);
     }
-#else
-    if ((!RLGL.ExtSupported.texCompDXT) && ((format == RL_PIXELFORMAT_COMPRESSED_DXT1_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_DXT1_RGBA) ||
-        (format == RL_PIXELFORMAT_COMPRESSED_DXT3_RGBA) || (format == RL_PIXELFORMAT_COMPRESSED_DXT5_RGBA)))
+
+    // Nothing submitted since the last sort: keys are still strictly increasing and the last draw empty
+    if (last.vertexCount == 0)
     {
-        TRACELOG(RL_LOG_WARNING, "GL: DXT compressed texture format not supported");
-        return id;
+        bool sorted = true;
+        for (int i = 1; (i < count) && sorted; i++) sorted = (keys[i - 1] < keys[i]);
+        if (sorted) return;
     }
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
-    if ((!RLGL.ExtSupported.texCompETC1) && (format == RL_PIXELFORMAT_COMPRESSED_ETC1_RGB))
+
+    // LSD radix sort, one byte per pass, skipping passes where all keys share the same byte
+    for (int shift = 0; shift < 64; shift += 8)
     {
-        TRACELOG(RL_LOG_WARNING, "GL: ETC1 compressed texture format not supported");
-        return id;
+        int histogram[256] = { 0 };
+        for (int i = 0; i < count; i++) histogram[(keys[i] >> shift) & 0xff]++;
+        if ((count == 0) || (histogram[(keys[0] >> shift) & 0xff] == count)) continue;
+
+        for (int i = 0, sum = 0; i < 256; i++)
+        {
+            int n = histogram[i];
+            histogram[i] = sum;
+            sum += n;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int slot = histogram[(keys[i] >> shift) & 0xff]++;
+            sortedKeys[slot] = keys[i];
+            sortedOrder[slot] = order[i];
+        }
+
+        memcpy(keys, sortedKeys, count*sizeof(unsigned long long));
+        memcpy(order, sortedOrder, count*sizeof(int));
     }
 
-    if ((!RLGL.ExtSupported.texCompETC2) && ((format == RL_PIXELFORMAT_COMPRESSED_ETC2_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA)))
+    // Move vertex data to sorted order, through a scratch copy of what is used
+    // NOTE: Scratch memory is sized for a full batch once, non-deferred batches never allocate it
+    rlVertexBuffer *buffer = &batch->vertexBuffer[batch->currentBuffer];
+    int used = RLGL.State.vertexCounter;
+    int capacity = buffer->elementCount*4;
+
+    if (batch->sortScratch == NULL)
     {
-        TRACELOG(RL_LOG_WARNING, "GL: ETC2 compressed texture format not supported");
-        return id;
+        int vertexSize = (buffer->interleaved != NULL)? sizeof(rlVertex) : (3*sizeof(float) + 2*sizeof(float) + 4*sizeof(unsigned char));
+        batch->sortScratch = RL_MALLOC(RL_DEFAULT_BATCH_DRAWCALLS*sizeof(rlDrawCall) + capacity*vertexSize);
     }
 
-    if ((!RLGL.ExtSupported.texCompPVRT) && ((format == RL_PIXELFORMAT_COMPRESSED_PVRT_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_PVRT_RGBA)))
+    rlDrawCall *draws = (rlDrawCall *)batch->sortScratch;
+    memcpy(draws, batch->draws, drawCount*sizeof(rlDrawCall));
+
+    rlVertex *interleaved = NULL;
+    float *vertices = NULL;
+    float *texcoords = NULL;
+    unsigned char *colors = NULL;
+
+    if (buffer->interleaved != NULL)
     {
-        TRACELOG(RL_LOG_WARNING, "GL: PVRT compressed texture format not supported");
-        return id;
+        interleaved = (rlVertex *)(draws + RL_DEFAULT_BATCH_DRAWCALLS);
+        memcpy(interleaved, buffer->interleaved, used*sizeof(rlVertex));
     }
-
-    if ((!RLGL.ExtSupported.texCompASTC) && ((format == RL_PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA) || (format == RL_PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA)))
+    else
     {
-        TRACELOG(RL_LOG_WARNING, "GL: ASTC compressed texture format not supported");
-        return id;
+        vertices = (float *)(draws + RL_DEFAULT_BATCH_DRAWCALLS);
+        texcoords = vertices + 3*capacity;
+        colors = (unsigned char *)(texcoords + 2*capacity);
+        memcpy(vertices, buffer->vertices, used*3*sizeof(float));
+        memcpy(texcoords, buffer->texcoords, used*2*sizeof(float));
+        memcpy(colors, buffer->colors, used*4*sizeof(unsigned char));
     }
-#endif
-#endif  // GRAPHICS_API_OPENGL_11
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    int merged = 0;
+    int vertexCounter = 0;
 
-    glGenTextures(1, &id);              // Generate texture id
+    for (int i = 0; i < count; i++)
+    {
+        const rlDrawCall *draw = &draws[order[i]];
+
+        if ((merged == 0) || (keys[i] != keys[i - 1]))
+        {
+            // Start a new draw, padding the previous one so this one starts at a multiple of 4 (QUADS indexing)
+            if (merged > 0)
+            {
+                int alignment = (4 - batch->draws[merged - 1].vertexCount%4)%4;
+                batch->draws[merged - 1].vertexAlignment = alignment;
+                vertexCounter += alignment;
+            }
+
+            batch->draws[merged] = *draw;
+            batch->draws[merged].vertexCount = 0;
+            batch->draws[merged].vertexAlignment = 0;
+            merged++;
+        }
+
+        int first = offsets[order[i]];
+        int n = draw->vertexCount;
+
+        if (interleaved != NULL) memcpy(buffer->interleaved + vertexCounter, interleaved + first, n*sizeof(rlVertex));
+        else
+        {
+            memcpy(buffer->vertices + 3*vertexCounter, vertices + 3*first, n*3*sizeof(float));
+            memcpy(buffer->texcoords + 2*vertexCounter, texcoords + 2*first, n*2*sizeof(float));
+            memcpy(buffer->colors + 4*vertexCounter, colors + 4*first, n*4*sizeof(unsigned char));
+        }
+
+        batch->draws[merged - 1].vertexCount += n;
+        vertexCounter += n;
+    }
+
+    // Open an empty draw with the last draw state, following vertex continue there
+    if (last.vertexCount > 0) batch->drawsRecorded++;
+
+    if (merged > 0)
+    {
+        int alignment = (4 - batch->draws[merged - 1].vertexCount%4)%4;
+        batch->draws[merged - 1].vertexAlignment = alignment;
+        vertexCounter += alignment;
+    }
+
+    batch->draws[merged] = last;
+    batch->draws[merged].vertexCount = 0;
+    batch->draws[merged].vertexAlignment = 0;
+    merged++;
+
+    for (int i = merged; i < drawCount; i++)
+    {
+        batch->draws[i].vertexCount = 0;
+        batch->draws[i].vertexAlignment = 0;
+    }
+
+    batch->drawCounter = merged;
+    RLGL.State.vertexCounter = vertexCounter;
+#endif
+}
+
+// Get render batch statistics accumulated since the last reset
+rlBatchStats rlGetBatchStats(void)
+{
+    rlBatchStats stats = { 0 };
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    stats = RLGL.batchStats;
+#endif
+    return stats;
+}
+
+// Reset render batch statistics
+void rlResetBatchStats(void)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    rlBatchStats stats = { 0 };
+    RLGL.batchStats = stats;
+#endif
+}
+
+// Wait until the GPU has executed all submitted commands
+// NOTE: Only meant to bound timings, it stalls the CPU for as long as the GPU lags behind
+void rlFinish(void)
+{
+    glFinish();
+}
+
+// Textures data management
+//-----------------------------------------------------------------------------------------
+// Convert image data to OpenGL texture (returns OpenGL valid Id)
+unsigned int rlLoadTexture(const void *data, int width, int height, int format, int mipmapCount)
+{
+    unsigned int id = 0;
+
+    glBindTexture(GL_TEXTURE_2D, 0);    // Free any old binding
+
+    // Check texture format support by OpenGL 1.1 (compressed textures not supported)
+#if defined(GRAPHICS_API_OPENGL_11)
+    if (format >= RL_PIXELFORMAT_COMPRESSED_DXT1_RGB)
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: OpenGL 1.1 does not support GPU compressed texture formats");
+        return id;
+    }
+#else
+    if ((!RLGL.ExtSupported.texCompDXT) && ((format == RL_PIXELFORMAT_COMPRESSED_DXT1_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_DXT1_RGBA) ||
+        (format == RL_PIXELFORMAT_COMPRESSED_DXT3_RGBA) || (format == RL_PIXELFORMAT_COMPRESSED_DXT5_RGBA)))
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: DXT compressed texture format not supported");
+        return id;
+    }
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if ((!RLGL.ExtSupported.texCompETC1) && (format == RL_PIXELFORMAT_COMPRESSED_ETC1_RGB))
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: ETC1 compressed texture format not supported");
+        return id;
+    }
+
+    if ((!RLGL.ExtSupported.texCompETC2) && ((format == RL_PIXELFORMAT_COMPRESSED_ETC2_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA)))
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: ETC2 compressed texture format not supported");
+        return id;
+    }
+
+    if ((!RLGL.ExtSupported.texCompPVRT) && ((format == RL_PIXELFORMAT_COMPRESSED_PVRT_RGB) || (format == RL_PIXELFORMAT_COMPRESSED_PVRT_RGBA)))
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: PVRT compressed texture format not supported");
+        return id;
+    }
+
+    if ((!RLGL.ExtSupported.texCompASTC) && ((format == RL_PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA) || (format == RL_PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA)))
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: ASTC compressed texture format not supported");
+        return id;
+    }
+#endif
+#endif  // GRAPHICS_API_OPENGL_11
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glGenTextures(1, &id);              // Generate texture id
 
     glBindTexture(GL_TEXTURE_2D, id);
 
@@ -2955,7 +3797,7 @@ unsigned int rlLoadTexture(const void *data, int width, int height, int format,
 
         TRACELOGD("TEXTURE: Load mipmap level %i (%i x %i), size: %i, offset: %i", i, mipWidth, mipHeight, mipSize, mipOffset);
 
-        if (glInternalFormat != -1)
+        if (glInternalFormat != 0)
         {
             if (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB) glTexImage2D(GL_TEXTURE_2D, i, glInternalFormat, mipWidth, mipHeight, 0, glFormat, glType, (unsigned char *)data + mipOffset);
 #if !defined(GRAPHICS_API_OPENGL_11)
@@ -3108,7 +3950,7 @@ unsigned int rlLoadTextureCubemap(const void *data, int size, int format)
     unsigned int glInternalFormat, glFormat, glType;
     rlGetGlTextureFormats(format, &glInternalFormat, &glFormat, &glType);
 
-    if (glInternalFormat != -1)
+    if (glInternalFormat != 0)
     {
         // Load cubemap faces
         for (unsigned int i = 0; i < 6; i++)
@@ -3180,7 +4022,7 @@ void rlUpdateTexture(unsigned int id, int offsetX, int offsetY, int width, int h
     unsigned int glInternalFormat, glFormat, glType;
     rlGetGlTextureFormats(format, &glInternalFormat, &glFormat, &glType);
 
-    if ((glInternalFormat != -1) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB))
+    if ((glInternalFormat != 0) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB))
     {
         glTexSubImage2D(GL_TEXTURE_2D, 0, offsetX, offsetY, width, height, glFormat, glType, data);
     }
@@ -3245,6 +4087,290 @@ void rlUnloadTexture(unsigned int id)
     glDeleteTextures(1, &id);
 }
 
+// Load an empty RGBA8 texture atlas
+// NOTE: Images are packed on a skyline (bottom-left), areas released by rlAtlasEvict()
+// are reused first, best area fit, and split in two for what is left of them
+rlAtlas rlLoadAtlas(int width, int height, int padding, bool extrude)
+{
+    rlAtlas atlas = { 0 };
+
+    atlas.id = rlLoadTexture(NULL, width, height, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+    atlas.width = width;
+    atlas.height = height;
+    atlas.padding = padding;
+    atlas.extrude = extrude;
+
+    // Every segment is at least one pixel wide, plus one for rlAtlasInsert(), which inserts
+    // the new segment before trimming the ones it covers
+    atlas.skyline = (rlAtlasNode *)RL_CALLOC(width + 1, sizeof(rlAtlasNode));
+    atlas.skyline[0].width = width;
+    atlas.skylineCount = 1;
+
+    return atlas;
+}
+
+// Unload texture atlas
+void rlUnloadAtlas(rlAtlas atlas)
+{
+    rlUnloadTexture(atlas.id);
+    RL_FREE(atlas.skyline);
+    RL_FREE(atlas.freeRects);
+}
+
+// Pack RGBA8 image into atlas and upload it (false if it does not fit)
+bool rlAtlasInsert(rlAtlas *atlas, const void *data, int width, int height, rlAtlasRegion *region)
+{
+    int cellWidth = width + 2*atlas->padding;
+    int cellHeight = height + 2*atlas->padding;
+    int x = -1, y = -1;
+
+    // Smallest evicted area the image fits in
+    int bestFree = -1;
+    for (int i = 0; i < atlas->freeCount; i++)
+    {
+        rlAtlasNode *rect = &atlas->freeRects[i];
+
+        if ((rect->width >= cellWidth) && (rect->height >= cellHeight) &&
+            ((bestFree < 0) || (rect->width*rect->height < atlas->freeRects[bestFree].width*atlas->freeRects[bestFree].height))) bestFree = i;
+    }
+
+    if (bestFree >= 0)
+    {
+        rlAtlasNode rect = atlas->freeRects[bestFree];
+        x = rect.x;
+        y = rect.y;
+
+        // Split what is left along the shorter side, keeping the bigger piece in one rectangle
+        rlAtlasNode right = { rect.x + cellWidth, rect.y, rect.width - cellWidth, cellHeight };
+        rlAtlasNode bottom = { rect.x, rect.y + cellHeight, rect.width, rect.height - cellHeight };
+        if ((rect.width - cellWidth) > (rect.height - cellHeight))
+        {
+            right.height = rect.height;
+            bottom.width = cellWidth;
+        }
+
+        atlas->freeRects[bestFree] = atlas->freeRects[--atlas->freeCount];
+
+        if ((right.width > 0) && (right.height > 0)) rlAtlasAddFreeRect(atlas, right);
+        if ((bottom.width > 0) && (bottom.height > 0)) rlAtlasAddFreeRect(atlas, bottom);
+    }
+    else
+    {
+        // Lowest position on the skyline, narrowest segment on ties
+        int bestNode = -1;
+        int bestWidth = 0;
+
+        for (int i = 0; i < atlas->skylineCount; i++)
+        {
+            int left = atlas->skyline[i].x;
+            if (left + cellWidth > atlas->width) break;
+
+            // Image rests on the highest segment under it
+            int top = 0;
+            for (int j = i, covered = 0; covered < cellWidth; j++)
+            {
+                if (atlas->skyline[j].y > top) top = atlas->skyline[j].y;
+                covered += atlas->skyline[j].width;
+            }
+
+            if (top + cellHeight > atlas->height) continue;
+
+            if ((bestNode < 0) || (top < y) || ((top == y) && (atlas->skyline[i].width < bestWidth)))
+            {
+                bestNode = i;
+                bestWidth = atlas->skyline[i].width;
+                x = left;
+                y = top;
+            }
+        }
+
+        if (bestNode < 0) return false;
+
+        // Add the new segment and shrink or remove the ones it covers
+        memmove(&atlas->skyline[bestNode + 1], &atlas->skyline[bestNode], (atlas->skylineCount - bestNode)*sizeof(rlAtlasNode));
+        atlas->skyline[bestNode].x = x;
+        atlas->skyline[bestNode].y = y + cellHeight;
+        atlas->skyline[bestNode].width = cellWidth;
+        atlas->skylineCount++;
+
+        for (int i = bestNode + 1; i < atlas->skylineCount; i++)
+        {
+            int end = atlas->skyline[i - 1].x + atlas->skyline[i - 1].width;
+            if (atlas->skyline[i].x >= end) break;
+
+            int shrink = end - atlas->skyline[i].x;
+            if (shrink < atlas->skyline[i].width)
+            {
+                atlas->skyline[i].x += shrink;
+                atlas->skyline[i].width -= shrink;
+                break;
+            }
+
+            memmove(&atlas->skyline[i], &atlas->skyline[i + 1], (atlas->skylineCount - i - 1)*sizeof(rlAtlasNode));
+            atlas->skylineCount--;
+            i--;
+        }
+
+        rlAtlasMergeSkyline(atlas);
+    }
+
+    // Upload image with its padding, filled with transparent or edge pixels
+    if (atlas->padding > 0)
+    {
+        const unsigned char *pixels = (const unsigned char *)data;
+        unsigned char *cell = (unsigned char *)RL_CALLOC(cellWidth*cellHeight, 4);
+
+        for (int cy = 0; cy < cellHeight; cy++)
+        {
+            int sy = cy - atlas->padding;
+            if (atlas->extrude) sy = (sy < 0)? 0 : ((sy >= height)? height - 1 : sy);
+            else if ((sy < 0) || (sy >= height)) continue;
+
+            for (int cx = 0; cx < cellWidth; cx++)
+            {
+                int sx = cx - atlas->padding;
+                if (atlas->extrude) sx = (sx < 0)? 0 : ((sx >= width)? width - 1 : sx);
+                else if ((sx < 0) || (sx >= width)) continue;
+
+                memcpy(cell + 4*(cy*cellWidth + cx), pixels + 4*(sy*width + sx), 4);
+            }
+        }
+
+        rlUpdateTexture(atlas->id, x, y, cellWidth, cellHeight, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, cell);
+        RL_FREE(cell);
+    }
+    else rlUpdateTexture(atlas->id, x, y, width, height, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, data);
+
+    atlas->usedArea += cellWidth*cellHeight;
+
+    region->x = x + atlas->padding;
+    region->y = y + atlas->padding;
+    region->width = width;
+    region->height = height;
+    region->u0 = (float)region->x/atlas->width;
+    region->v0 = (float)region->y/atlas->height;
+    region->u1 = (float)(region->x + width)/atlas->width;
+    region->v1 = (float)(region->y + height)/atlas->height;
+
+    return true;
+}
+
+// Release an image area, reused by later insertions
+// NOTE: Released areas are merged with free neighbours sharing a whole edge,
+// and given back to the skyline when right under it
+void rlAtlasEvict(rlAtlas *atlas, rlAtlasRegion region)
+{
+    rlAtlasNode rect = { region.x - atlas->padding, region.y - atlas->padding,
+                         region.width + 2*atlas->padding, region.height + 2*atlas->padding };
+
+    atlas->usedArea -= rect.width*rect.height;
+
+    for (int i = 0; i < atlas->freeCount; i++)
+    {
+        rlAtlasNode *free = &atlas->freeRects[i];
+        bool merged = false;
+
+        if ((free->x == rect.x) && (free->width == rect.width))
+        {
+            if (free->y + free->height == rect.y) { rect.y = free->y; rect.height += free->height; merged = true; }
+            else if (rect.y + rect.height == free->y) { rect.height += free->height; merged = true; }
+        }
+        else if ((free->y == rect.y) && (free->height == rect.height))
+        {
+            if (free->x + free->width == rect.x) { rect.x = free->x; rect.width += free->width; merged = true; }
+            else if (rect.x + rect.width == free->x) { rect.width += free->width; merged = true; }
+        }
+
+        // Start over, the bigger area may now match others
+        if (merged)
+        {
+            atlas->freeRects[i] = atlas->freeRects[--atlas->freeCount];
+            i = -1;
+        }
+    }
+
+    if (!rlAtlasLowerSkyline(atlas, rect))
+    {
+        rlAtlasAddFreeRect(atlas, rect);
+        return;
+    }
+
+    // Free areas the skyline went down to can go back to it too
+    for (int i = 0; i < atlas->freeCount; i++)
+    {
+        if (rlAtlasLowerSkyline(atlas, atlas->freeRects[i]))
+        {
+            atlas->freeRects[i] = atlas->freeRects[--atlas->freeCount];
+            i = -1;
+        }
+    }
+}
+
+// Merge atlas skyline neighbour segments at the same height
+static void rlAtlasMergeSkyline(rlAtlas *atlas)
+{
+    for (int i = 0; i < atlas->skylineCount - 1; i++)
+    {
+        if (atlas->skyline[i].y == atlas->skyline[i + 1].y)
+        {
+            atlas->skyline[i].width += atlas->skyline[i + 1].width;
+            memmove(&atlas->skyline[i + 1], &atlas->skyline[i + 2], (atlas->skylineCount - i - 2)*sizeof(rlAtlasNode));
+            atlas->skylineCount--;
+            i--;
+        }
+    }
+}
+
+// Give an area right under the atlas skyline back to it (false if it is not right under it)
+static bool rlAtlasLowerSkyline(rlAtlas *atlas, rlAtlasNode rect)
+{
+    int left = rect.x;
+    int right = rect.x + rect.width;
+
+    for (int i = 0; i < atlas->skylineCount; i++)
+    {
+        const rlAtlasNode *node = &atlas->skyline[i];
+        if ((node->x < right) && (node->x + node->width > left) && (node->y != rect.y + rect.height)) return false;
+    }
+
+    // Split segments at both ends of the area, then lower the ones in between
+    for (int i = 0; i < atlas->skylineCount; i++)
+    {
+        rlAtlasNode node = atlas->skyline[i];
+        int cut = -1;
+
+        if ((node.x < left) && (node.x + node.width > left)) cut = left;
+        else if ((node.x < right) && (node.x + node.width > right)) cut = right;
+
+        if (cut >= 0)
+        {
+            memmove(&atlas->skyline[i + 1], &atlas->skyline[i], (atlas->skylineCount - i)*sizeof(rlAtlasNode));
+            atlas->skyline[i].width = cut - node.x;
+            atlas->skyline[i + 1].x = cut;
+            atlas->skyline[i + 1].width = node.x + node.width - cut;
+            atlas->skylineCount++;
+            i--;    // Check the segment left of the cut again
+        }
+        else if ((node.x >= left) && (node.x + node.width <= right)) atlas->skyline[i].y = rect.y;
+    }
+
+    rlAtlasMergeSkyline(atlas);
+
+    return true;
+}
+
+// Add an area to the atlas free rectangles
+static void rlAtlasAddFreeRect(rlAtlas *atlas, rlAtlasNode rect)
+{
+    if (atlas->freeCount == atlas->freeCapacity)
+    {
+        atlas->freeCapacity = (atlas->freeCapacity > 0)? 2*atlas->freeCapacity : 64;
+        atlas->freeRects = (rlAtlasNode *)RL_REALLOC(atlas->freeRects, atlas->freeCapacity*sizeof(rlAtlasNode));
+    }
+
+    atlas->freeRects[atlas->freeCount++] = rect;
+}
+
 // Generate mipmap data for selected texture
 // NOTE: Only supports GPU mipmap generation
 void rlGenTextureMipmaps(unsigned int id, int width, int height, int format, int *mipmaps)
@@ -3303,7 +4429,7 @@ void *rlReadTexturePixels(unsigned int id, int width, int height, int format)
     rlGetGlTextureFormats(format, &glInternalFormat, &glFormat, &glType);
     unsigned int size = rlGetPixelDataSize(width, height, format);
 
-    if ((glInternalFormat != -1) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB))
+    if ((glInternalFormat != 0) && (format < RL_PIXELFORMAT_COMPRESSED_DXT1_RGB))
     {
         pixels = RL_MALLOC(size);
         glGetTexImage(GL_TEXTURE_2D, 0, glFormat, glType, pixels);
@@ -3635,6 +4761,113 @@ void rlDrawVertexArrayElementsInstanced(int offset, int count, const void *buffe
 #endif
 }
 
+// Load instanced mesh (XYZ positions, triangles) with room for maxInstances
+// NOTE: Instance transforms and colors are undefined until rlUpdateInstancedMesh()
+rlInstancedMesh rlLoadInstancedMesh(const float *positions, int vertexCount, int maxInstances)
+{
+    rlInstancedMesh mesh = { 0 };
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if (!RLGL.ExtSupported.instancing)
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: Instanced meshes not supported (instancing not available)");
+        return mesh;
+    }
+
+    if (RLGL.State.instancedShaderId == 0) rlLoadShaderInstanced();
+    if (RLGL.State.instancedShaderId == 0) return mesh;
+
+    mesh.vertexCount = vertexCount;
+    mesh.maxInstances = maxInstances;
+
+    mesh.vboId[0] = rlLoadVertexBuffer(positions, vertexCount*3*sizeof(float), false);
+    mesh.vboId[1] = rlLoadVertexBuffer(NULL, maxInstances*sizeof(Matrix), true);
+    mesh.vboId[2] = rlLoadVertexBuffer(NULL, maxInstances*4*sizeof(unsigned char), true);
+
+    if (RLGL.ExtSupported.vao)
+    {
+        mesh.vaoId = rlLoadVertexArray();
+        glBindVertexArray(mesh.vaoId);
+        rlSetInstancedMeshAttributes(mesh);
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#else
+    TRACELOG(RL_LOG_WARNING, "GL: Instanced meshes not supported (OpenGL 1.1)");
+#endif
+
+    return mesh;
+}
+
+// Unload instanced mesh
+void rlUnloadInstancedMesh(rlInstancedMesh mesh)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if (mesh.vaoId > 0) rlUnloadVertexArray(mesh.vaoId);
+    for (int i = 0; i < 3; i++) if (mesh.vboId[i] > 0) glDeleteBuffers(1, &mesh.vboId[i]);
+#endif
+}
+
+// Update first count instances transforms and RGBA colors (NULL to keep)
+void rlUpdateInstancedMesh(rlInstancedMesh mesh, const Matrix *transforms, const unsigned char *colors, int count)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if (count > mesh.maxInstances)
+    {
+        TRACELOG(RL_LOG_WARNING, "GL: Instanced mesh holds %i instances, %i requested", mesh.maxInstances, count);
+        count = mesh.maxInstances;
+    }
+
+    if (count <= 0) return;
+
+    if (transforms != NULL) rlUpdateVertexBuffer(mesh.vboId[1], transforms, count*sizeof(Matrix), 0);
+    if (colors != NULL) rlUpdateVertexBuffer(mesh.vboId[2], colors, count*4*sizeof(unsigned char), 0);
+#endif
+}
+
+// Draw first instances of the mesh in one call, after drawing the active batch
+// NOTE: Uses current modelview (and transform, when inside rlPushMatrix()/rlPopMatrix()) and projection
+void rlDrawInstancedMesh(rlInstancedMesh mesh, int instances)
+{
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+    if ((mesh.vboId[0] == 0) || (instances <= 0)) return;
+    if (instances > mesh.maxInstances) instances = mesh.maxInstances;
+
+    // Anything already batched has to be drawn first to keep draw order
+    rlDrawRenderBatch(RLGL.currentBatch);
+
+    Matrix matModelView = RLGL.State.modelview;
+    if (RLGL.State.transformRequired) matModelView = rlMatrixMultiply(RLGL.State.transform, matModelView);
+
+    glUseProgram(RLGL.State.instancedShaderId);
+    rlSetUniformMatrix(RLGL.State.instancedShaderLocs[0], rlMatrixMultiply(matModelView, RLGL.State.projection));
+
+    if (RLGL.ExtSupported.vao) glBindVertexArray(mesh.vaoId);
+    else rlSetInstancedMeshAttributes(mesh);
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, mesh.vertexCount, instances);
+
+    if (RLGL.ExtSupported.vao) glBindVertexArray(0);
+    else
+    {
+        // Without VAO, divisors are global state, and batch attributes share these locations
+        for (int i = 1; i < 4; i++)
+        {
+            int count = (i == 3)? 4 : 1;
+            for (int j = 0; j < count; j++)
+            {
+                glVertexAttribDivisor(RLGL.State.instancedShaderLocs[i] + j, 0);
+                glDisableVertexAttribArray(RLGL.State.instancedShaderLocs[i] + j);
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glUseProgram(0);
+#endif
+}
+
 #if defined(GRAPHICS_API_OPENGL_11)
 // Enable vertex state pointer
 void rlEnableStatePointer(int vertexAttribType, void *buffer)
@@ -4018,6 +5251,7 @@ void rlSetShader(unsigned int id, int *locs)
 #if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
     if (RLGL.State.currentShaderId != id)
     {
+        RLGL.State.flushCause = RL_FLUSH_STATE_CHANGE;
         rlDrawRenderBatch(RLGL.currentBatch);
         RLGL.State.currentShaderId = id;
         RLGL.State.currentShaderLocs = locs;
@@ -4567,11 +5801,133 @@ static void rlUnloadShaderDefault(void)
 
     glDeleteProgram(RLGL.State.defaultShaderId);
 
+    if (RLGL.State.instancedShaderId > 0) glDeleteProgram(RLGL.State.instancedShaderId);
+    RLGL.State.instancedShaderId = 0;
+
     RL_FREE(RLGL.State.defaultShaderLocs);
 
     TRACELOG(RL_LOG_INFO, "SHADER: [ID %i] Default shader unloaded successfully", RLGL.State.defaultShaderId);
 }
 
+// Make room for a new draw call once RL_DEFAULT_BATCH_DRAWCALLS are used
+// NOTE: Deferred batches merge their draws first, and are only drawn if that does not free any
+static void rlCheckRenderBatchDrawLimit(void)
+{
+    if (RLGL.currentBatch->deferred) rlSortRenderBatch(RLGL.currentBatch);
+    if (RLGL.currentBatch->drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS)
+    {
+        RLGL.State.flushCause = RL_FLUSH_DRAW_LIMIT;
+        rlDrawRenderBatch(RLGL.currentBatch);
+    }
+}
+
+// Load instanced mesh shader
+// NOTE: Instance transforms are rlgl Matrix structs uploaded as they are, so each mat4 column
+// holds a matrix row and the position is multiplied on the left
+static void rlLoadShaderInstanced(void)
+{
+    const char *vShaderCode =
+#if defined(GRAPHICS_API_OPENGL_33)
+    "#version 330                       \n"
+    "in vec3 vertexPosition;            \n"
+    "in vec4 instanceColor;             \n"
+    "in mat4 instanceTransform;         \n"
+    "out vec4 fragColor;                \n"
+#endif
+#if defined(GRAPHICS_API_OPENGL_ES2)
+    "#version 100                       \n"
+    "attribute vec3 vertexPosition;     \n"
+    "attribute vec4 instanceColor;      \n"
+    "attribute mat4 instanceTransform;  \n"
+    "varying vec4 fragColor;            \n"
+#endif
+    "uniform mat4 mvp;                  \n"
+    "void main()                        \n"
+    "{                                  \n"
+    "    fragColor = instanceColor;     \n"
+    "    gl_Position = mvp*(vec4(vertexPosition, 1.0)*instanceTransform); \n"
+    "}                                  \n";
+
+    const char *fShaderCode =
+#if defined(GRAPHICS_API_OPENGL_33)
+    "#version 330                       \n"
+    "in vec4 fragColor;                 \n"
+    "out vec4 finalColor;               \n"
+    "void main()                        \n"
+    "{                                  \n"
+    "    finalColor = fragColor;        \n"
+    "}                                  \n";
+#endif
+#if defined(GRAPHICS_API_OPENGL_ES2)
+    "#version 100                       \n"
+    "precision mediump float;           \n"
+    "varying vec4 fragColor;            \n"
+    "void main()                        \n"
+    "{                                  \n"
+    "    gl_FragColor = fragColor;      \n"
+    "}                                  \n";
+#endif
+
+    RLGL.State.instancedShaderId = rlLoadShaderCode(vShaderCode, fShaderCode);
+
+    if (RLGL.State.instancedShaderId > 0)
+    {
+        RLGL.State.instancedShaderLocs[0] = glGetUniformLocation(RLGL.State.instancedShaderId, "mvp");
+        RLGL.State.instancedShaderLocs[1] = glGetAttribLocation(RLGL.State.instancedShaderId, "vertexPosition");
+        RLGL.State.instancedShaderLocs[2] = glGetAttribLocation(RLGL.State.instancedShaderId, "instanceColor");
+        RLGL.State.instancedShaderLocs[3] = glGetAttribLocation(RLGL.State.instancedShaderId, "instanceTransform");
+    }
+    else TRACELOG(RL_LOG_WARNING, "SHADER: Failed to load instanced mesh shader");
+}
+
+// Set vertex attributes for instanced mesh buffers
+// NOTE: Stored in the mesh VAO if supported, otherwise set before every draw
+static void rlSetInstancedMeshAttributes(rlInstancedMesh mesh)
+{
+    const int *locs = RLGL.State.instancedShaderLocs;
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vboId[0]);
+    glVertexAttribPointer(locs[1], 3, GL_FLOAT, 0, 0, 0);
+    glEnableVertexAttribArray(locs[1]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vboId[2]);
+    glVertexAttribPointer(locs[2], 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0);
+    glEnableVertexAttribArray(locs[2]);
+    glVertexAttribDivisor(locs[2], 1);
+
+    // One vec4 attribute per matrix column
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vboId[1]);
+    for (int i = 0; i < 4; i++)
+    {
+        glVertexAttribPointer(locs[3] + i, 4, GL_FLOAT, 0, sizeof(Matrix), (void *)(i*4*sizeof(float)));
+        glEnableVertexAttribArray(locs[3] + i);
+        glVertexAttribDivisor(locs[3] + i, 1);
+    }
+}
+
+// Get a monotonic time in seconds, for render batch statistics
+static double rlGetClock(void)
+{
+    struct timespec ts = { 0 };
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+// Set vertex attributes (position, texcoord, color) for interleaved rlVertex data on currently bound VBO
+static void rlSetVertexAttributesInterleaved(void)
+{
+    glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION]);
+    glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_POSITION], 3, GL_FLOAT, 0, sizeof(rlVertex), (void *)0);
+    glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
+    glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, GL_FLOAT, 0, sizeof(rlVertex), (void *)(3*sizeof(float)));
+    glEnableVertexAttribArray(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR]);
+    glVertexAttribPointer(RLGL.State.currentShaderLocs[RL_SHADER_LOC_VERTEX_COLOR], 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(rlVertex), (void *)(5*sizeof(float)));
+}
+
 #if defined(RLGL_SHOW_GL_DETAILS_INFO)
 // Get compressed format official GL identifier name
 static char *rlGetCompressedFormatName(int format)
@@ -4717,24 +6073,90 @@ static Matrix rlMatrixMultiply(Matrix left, Matrix right)
 {
     Matrix result = { 0 };
 
-    result.m0 = left.m0*right.m0 + left.m1*right.m4 + left.m2*right.m8 + left.m3*right.m12;
-    result.m1 = left.m0*right.m1 + left.m1*right.m5 + left.m2*right.m9 + left.m3*right.m13;
-    result.m2 = left.m0*right.m2 + left.m1*right.m6 + left.m2*right.m10 + left.m3*right.m14;
-    result.m3 = left.m0*right.m3 + left.m1*right.m7 + left.m2*right.m11 + left.m3*right.m15;
-    result.m4 = left.m4*right.m0 + left.m5*right.m4 + left.m6*right.m8 + left.m7*right.m12;
-    result.m5 = left.m4*right.m1 + left.m5*right.m5 + left.m6*right.m9 + left.m7*right.m13;
-    result.m6 = left.m4*right.m2 + left.m5*right.m6 + left.m6*right.m10 + left.m7*right.m14;
-    result.m7 = left.m4*right.m3 + left.m5*right.m7 + left.m6*right.m11 + left.m7*right.m15;
-    result.m8 = left.m8*right.m0 + left.m9*right.m4 + left.m10*right.m8 + left.m11*right.m12;
-    result.m9 = left.m8*right.m1 + left.m9*right.m5 + left.m10*right.m9 + left.m11*right.m13;
-    result.m10 = left.m8*right.m2 + left.m9*right.m6 + left.m10*right.m10 + left.m11*right.m14;
-    result.m11 = left.m8*right.m3 + left.m9*right.m7 + left.m10*right.m11 + left.m11*right.m15;
-    result.m12 = left.m12*right.m0 + left.m13*right.m4 + left.m14*right.m8 + left.m15*right.m12;
-    result.m13 = left.m12*right.m1 + left.m13*right.m5 + left.m14*right.m9 + left.m15*right.m13;
-    result.m14 = left.m12*right.m2 + left.m13*right.m6 + left.m14*right.m10 + left.m15*right.m14;
-    result.m15 = left.m12*right.m3 + left.m13*right.m7 + left.m14*right.m11 + left.m15*right.m15;
+    rlMatrixMultiplyTo(&left, &right, &result);
 
     return result;
 }
 
+// Multiply two matrices into result, which can be left or right (matrix stack updates in place)
+// NOTE: Matrix memory rows are (m0, m4, m8, m12), (m1, m5, m9, m13)..., so result memory row j is
+// the sum of left memory rows k scaled by right element [4*j + k], added in the same order as the scalar code.
+// Left is fully loaded and every right row read before its result row is written, so aliasing is fine
+static void rlMatrixMultiplyTo(const Matrix *left, const Matrix *right, Matrix *result)
+{
+
+#if defined(RLGL_SIMD_SSE)
+    const float *l = &left->m0;
+    const float *r = &right->m0;
+    float *o = &result->m0;
+
+    __m128 l0 = _mm_loadu_ps(l), l1 = _mm_loadu_ps(l + 4), l2 = _mm_loadu_ps(l + 8), l3 = _mm_loadu_ps(l + 12);
+
+    for (int j = 0; j < 16; j += 4)
+    {
+        _mm_storeu_ps(o + j, _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(l0, _mm_set1_ps(r[j])), _mm_mul_ps(l1, _mm_set1_ps(r[j + 1]))),
+            _mm_mul_ps(l2, _mm_set1_ps(r[j + 2]))), _mm_mul_ps(l3, _mm_set1_ps(r[j + 3]))));
+    }
+#elif defined(RLGL_SIMD_NEON)
+    const float *l = &left->m0;
+    const float *r = &right->m0;
+    float *o = &result->m0;
+
+    float32x4_t l0 = vld1q_f32(l), l1 = vld1q_f32(l + 4), l2 = vld1q_f32(l + 8), l3 = vld1q_f32(l + 12);
+
+    for (int j = 0; j < 16; j += 4)
+    {
+        vst1q_f32(o + j, vaddq_f32(vaddq_f32(vaddq_f32(
+            vmulq_n_f32(l0, r[j]), vmulq_n_f32(l1, r[j + 1])),
+            vmulq_n_f32(l2, r[j + 2])), vmulq_n_f32(l3, r[j + 3])));
+    }
+#else
+    Matrix l = *left;
+    Matrix r = *right;
+    Matrix m = { 0 };
+
+    m.m0 = l.m0*r.m0 + l.m1*r.m4 + l.m2*r.m8 + l.m3*r.m12;
+    m.m1 = l.m0*r.m1 + l.m1*r.m5 + l.m2*r.m9 + l.m3*r.m13;
+    m.m2 = l.m0*r.m2 + l.m1*r.m6 + l.m2*r.m10 + l.m3*r.m14;
+    m.m3 = l.m0*r.m3 + l.m1*r.m7 + l.m2*r.m11 + l.m3*r.m15;
+    m.m4 = l.m4*r.m0 + l.m5*r.m4 + l.m6*r.m8 + l.m7*r.m12;
+    m.m5 = l.m4*r.m1 + l.m5*r.m5 + l.m6*r.m9 + l.m7*r.m13;
+    m.m6 = l.m4*r.m2 + l.m5*r.m6 + l.m6*r.m10 + l.m7*r.m14;
+    m.m7 = l.m4*r.m3 + l.m5*r.m7 + l.m6*r.m11 + l.m7*r.m15;
+    m.m8 = l.m8*r.m0 + l.m9*r.m4 + l.m10*r.m8 + l.m11*r.m12;
+    m.m9 = l.m8*r.m1 + l.m9*r.m5 + l.m10*r.m9 + l.m11*r.m13;
+    m.m10 = l.m8*r.m2 + l.m9*r.m6 + l.m10*r.m10 + l.m11*r.m14;
+    m.m11 = l.m8*r.m3 + l.m9*r.m7 + l.m10*r.m11 + l.m11*r.m15;
+    m.m12 = l.m12*r.m0 + l.m13*r.m4 + l.m14*r.m8 + l.m15*r.m12;
+    m.m13 = l.m12*r.m1 + l.m13*r.m5 + l.m14*r.m9 + l.m15*r.m13;
+    m.m14 = l.m12*r.m2 + l.m13*r.m6 + l.m14*r.m10 + l.m15*r.m14;
+    m.m15 = l.m12*r.m3 + l.m13*r.m7 + l.m14*r.m11 + l.m15*r.m15;
+
+    *result = m;
+#endif
+}
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+// Flag transform columns for update if the current matrix is the transform
+// NOTE: Called after every write to *RLGL.State.currentMatrix, so rlVertex3f() never uses stale columns,
+// they are only transposed again once a vertex needs them, not on every rlTranslatef()/rlRotatef()...
+static void rlCurrentMatrixChanged(void)
+{
+    if (RLGL.State.currentMatrix == &RLGL.State.transform) RLGL.State.transformChanged = true;
+}
+
+#if defined(RLGL_SIMD_SSE) || defined(RLGL_SIMD_NEON)
+// Transpose transform matrix into RLGL.State.transformColumns
+static void rlUpdateTransformColumns(void)
+{
+    const float *m = &RLGL.State.transform.m0;
+
+    for (int i = 0; i < 16; i++) RLGL.State.transformColumns[i] = m[4*(i%4) + i/4];
+
+    RLGL.State.transformChanged = false;
+}
+#endif
+#endif
+
 #endif  // RLGL_IMPLEMENTATION
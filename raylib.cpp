@@ -1,19 +1,1311 @@
 // cl /std:c++17 /nologo /Zi /MD /Iinclude raylib.cpp lib/raylib.lib user32.lib shell32.lib gdi32.lib winmm.lib
+// cl /std:c++17 /nologo /Zi /MD /Iinclude /DRLGL_SDL2 raylib.cpp lib/sdl2.lib lib/sdl2main.lib
+// g++ -std=c++17 -O2 -Iinclude -DRLGL_SDL2 raylib.cpp -o raylib-sdl2 -lSDL2 -lEGL
+//
+// raylib [--submit N] [--sprites N] [--flush N] [--ui N] [--instanced N]
+//        [--atlas N] [--matrix N] [--stats] [--frames N]
+// raylib-sdl2 [--headless] [--size WxH] + the options above
+//
+// lib/raylib.lib has to be built against include/rlgl.h, which adds the rlgl
+// functions used below. With RLGL_SDL2, rlgl.h is compiled in on SDL2 instead.
+//
+// --headless     surfaceless EGL context and an FBO of --size (Linux only)
+// --submit N     N vertices per frame, rlVertex3f vs rlVertexArray3f
+// --sprites N    N sprites, separate vs interleaved vertex buffers
+// --flush N      N sprites through default-size batches of 1, 2 and 3 buffers,
+//                submit time and total up to glFinish (on llvmpipe, which never
+//                lags behind, a fence only moves rasterizing into the submit)
+// --ui N         N widgets, plain batch vs sorted and merged deferred batch
+// --instanced N  N triangles as hexagons, rlgl matrix stack vs rlInstancedMesh
+// --atlas N      N sprites, a texture each vs packed rlAtlas pages
+// --matrix N     N push/translate/rotate/scale/pop sequences vs scalar math
+// --stats        rlGetBatchStats per frame, summed and for the worst frame
+// --frames N     close after N frames
 
+#if defined(RLGL_SDL2)
+#define SDL_MAIN_HANDLED
+#define GRAPHICS_API_OPENGL_33
+#define RLGL_IMPLEMENTATION
+
+#include <SDL2/SDL.h>
+
+// EGL has to come before glad (included by rlgl.h), which otherwise provides
+// its own copy of khrplatform.h without the KHRONOS_APIENTRY that EGL needs
+#if defined(__linux__)
+#define HAS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#else
 #include <raylib.h>
+#endif
 #include <rlgl.h>
 
-int main() {
+#include <bench.h>
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if defined(RLGL_SDL2)
+const char *usage = "usage: %s [--headless] [--size WxH] [--submit N] "
+                    "[--sprites N] [--flush N] [--ui N] [--instanced N] "
+                    "[--atlas N] [--matrix N] [--stats] [--frames N]\n";
+#else
+const char *usage = "usage: %s [--submit N] [--sprites N] [--flush N] "
+                    "[--ui N] [--instanced N] [--atlas N] [--matrix N] "
+                    "[--stats] [--frames N]\n";
+#endif
+
+struct Options {
+  int submit;
+  int sprites;
+  int flush;
+  int ui;
+  int instanced;
+  int atlas;
+  int matrix;
+  bool stats;
+  int frames;
+  bool headless;
+  int width;
+  int height;
+};
+
+Options opts;
+
+bool parse_options(int argc, char **argv) {
+  opts.submit = 0;
+  opts.sprites = 0;
+  opts.flush = 0;
+  opts.ui = 0;
+  opts.instanced = 0;
+  opts.atlas = 0;
+  opts.matrix = 0;
+  opts.stats = false;
+  opts.frames = 0;
+  opts.headless = false;
+  opts.width = 800;
+  opts.height = 600;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--submit") == 0) {
+      opts.submit = atoi(argv[++i]) / 3 * 3;
+    } else if (i + 1 < argc && strcmp(argv[i], "--sprites") == 0) {
+      opts.sprites = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--flush") == 0) {
+      opts.flush = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--ui") == 0) {
+      opts.ui = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--instanced") == 0) {
+      opts.instanced = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--atlas") == 0) {
+      opts.atlas = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--matrix") == 0) {
+      opts.matrix = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      opts.stats = true;
+    } else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0) {
+      opts.frames = atoi(argv[++i]);
+#if defined(RLGL_SDL2)
+    } else if (strcmp(argv[i], "--headless") == 0) {
+      opts.headless = true;
+    } else if (i + 1 < argc && strcmp(argv[i], "--size") == 0) {
+      if (sscanf(argv[++i], "%dx%d", &opts.width, &opts.height) != 2) {
+        return false;
+      }
+#endif
+    } else {
+      return false;
+    }
+  }
+
+  return opts.submit >= 0 && opts.sprites >= 0 && opts.flush >= 0 &&
+         opts.ui >= 0 && opts.instanced >= 0 && opts.atlas >= 0 &&
+         opts.matrix >= 0 && opts.frames >= 0 && opts.width > 0 && opts.height > 0;
+}
+
+#if defined(RLGL_SDL2)
+// The part of raylib's core this file uses, on SDL2 or headless EGL
+
+struct Color {
+  unsigned char r, g, b, a;
+};
+
+#define FLAG_WINDOW_RESIZABLE 0x00000004
+
+struct Platform {
+  unsigned int flags;
+  SDL_Window *window;
+  SDL_GLContext context;
+  bool quit;
+#if defined(HAS_EGL)
+  HeadlessEgl egl;
+  GLuint fbo;
+  GLuint color;
+#endif
+  std::chrono::steady_clock::time_point frame_begin;
+  std::vector<double> frame_ms;
+};
+
+Platform platform;
+
+#if defined(HAS_EGL)
+// Same as sdl2-opengl.cpp: a GL 3.3 core context from bench.h, and frames go
+// into an FBO
+bool create_headless(int width, int height) {
+  if (!create_headless_egl(&platform.egl, false, 3, 3)) {
+    return false;
+  }
+
+  rlLoadExtensions((void *)eglGetProcAddress);
+
+  // rlgl never binds framebuffer 0 unless a render texture is used, so the
+  // FBO stays bound for everything drawn through the default batch
+  glGenRenderbuffers(1, &platform.color);
+  glBindRenderbuffer(GL_RENDERBUFFER, platform.color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenFramebuffers(1, &platform.fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, platform.fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, platform.color);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf(stderr, "headless framebuffer is incomplete\n");
+    return false;
+  }
+
+  print_headless_egl(&platform.egl, (const char *)glGetString(GL_RENDERER),
+                     (const char *)glGetString(GL_VERSION));
+  return true;
+}
+
+void destroy_headless() {
+  glDeleteFramebuffers(1, &platform.fbo);
+  glDeleteRenderbuffers(1, &platform.color);
+  destroy_headless_egl(&platform.egl);
+}
+#endif
+
+void SetConfigFlags(unsigned int flags) { platform.flags = flags; }
+
+void InitWindow(int width, int height, const char *title) {
+  if (opts.headless) {
+#if defined(HAS_EGL)
+    if (!create_headless(width, height)) {
+      exit(1);
+    }
+#else
+    fprintf(stderr, "--headless needs EGL, which is only wired up on Linux\n");
+    exit(1);
+#endif
+  } else {
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
+                        SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+
+    Uint32 window_flags = SDL_WINDOW_OPENGL;
+    if (platform.flags & FLAG_WINDOW_RESIZABLE) {
+      window_flags |= SDL_WINDOW_RESIZABLE;
+    }
+
+    platform.window =
+        SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                         width, height, window_flags);
+    if (platform.window == nullptr) {
+      fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
+      exit(1);
+    }
+
+    platform.context = SDL_GL_CreateContext(platform.window);
+    SDL_GL_SetSwapInterval(0);
+    rlLoadExtensions((void *)SDL_GL_GetProcAddress);
+  }
+
+  // as raylib's InitWindow: default batch and shader, then a 2D viewport
+  rlglInit(width, height);
+  rlViewport(0, 0, width, height);
+  rlMatrixMode(RL_PROJECTION);
+  rlLoadIdentity();
+  rlOrtho(0, width, height, 0, 0.0f, 1.0f);
+  rlMatrixMode(RL_MODELVIEW);
+  rlLoadIdentity();
+}
+
+bool WindowShouldClose() {
+  SDL_Event event;
+  while (platform.window && SDL_PollEvent(&event)) {
+    if (event.type == SDL_QUIT) {
+      platform.quit = true;
+    } else if (event.type == SDL_WINDOWEVENT &&
+               event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+      rlViewport(0, 0, event.window.data1, event.window.data2);
+    }
+  }
+  return platform.quit;
+}
+
+void BeginDrawing() {
+  platform.frame_begin = std::chrono::steady_clock::now();
+  rlLoadIdentity();
+}
+
+void EndDrawing() {
+  rlDrawRenderBatchActive();
+  if (platform.window) {
+    SDL_GL_SwapWindow(platform.window);
+  } else {
+    glFinish();
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  platform.frame_ms.push_back(
+      std::chrono::duration<double, std::milli>(end - platform.frame_begin)
+          .count());
+}
+
+void ClearBackground(Color color) {
+  rlClearColor(color.r, color.g, color.b, color.a);
+  rlClearScreenBuffers();
+}
+
+void CloseWindow() {
+  rlglClose();
+  if (platform.window) {
+    SDL_GL_DeleteContext(platform.context);
+    SDL_DestroyWindow(platform.window);
+    SDL_Quit();
+  }
+#if defined(HAS_EGL)
+  else {
+    destroy_headless();
+  }
+#endif
+}
+
+#endif
+
+struct Submit {
+  std::vector<float> positions;
+  std::vector<unsigned char> colors;
+  rlRenderBatch batch;
+  double single_ms;
+  double bulk_ms;
+  int frames;
+};
+
+Submit submit;
+
+void init_submit() {
+  int count = opts.submit;
+  submit.positions.resize(count * 3);
+  submit.colors.resize(count * 4);
+
+  // small triangles scattered over [-1, 1], in distinct colors
+  srand(1);
+  for (int t = 0; t < count / 3; t++) {
+    float x = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    float y = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    float corners[3][2] = {{0.0f, 0.02f}, {-0.02f, -0.02f}, {0.02f, -0.02f}};
+    for (int v = 0; v < 3; v++) {
+      float *p = &submit.positions[(t * 3 + v) * 3];
+      p[0] = x + corners[v][0];
+      p[1] = y + corners[v][1];
+      p[2] = 0.0f;
+
+      unsigned char *c = &submit.colors[(t * 3 + v) * 4];
+      c[0] = (unsigned char)(t * 37);
+      c[1] = (unsigned char)(t * 91);
+      c[2] = (unsigned char)(t * 13);
+      c[3] = 255;
+    }
+  }
+
+  // one element is a quad, 4 vertices, and rlVertex3f keeps 4 spare
+  submit.batch = rlLoadRenderBatch(1, count / 4 + 2);
+}
+
+double submit_vertices(bool bulk, float angle) {
+  const float *positions = submit.positions.data();
+  const unsigned char *colors = submit.colors.data();
+  int count = opts.submit;
+
+  rlMatrixMode(RL_MODELVIEW);
+  rlPushMatrix();
+  rlRotatef(angle, 0.0f, 0.0f, 1.0f);
+  rlScalef(0.5f, 0.5f, 1.0f);
+  rlSetRenderBatchActive(&submit.batch);
+
+  auto begin = std::chrono::steady_clock::now();
+  rlBegin(RL_TRIANGLES);
+  if (bulk) {
+    rlVertexArray3f(positions, colors, count);
+  } else {
+    for (int i = 0; i < count; i++) {
+      rlColor4ub(colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2],
+                 colors[i * 4 + 3]);
+      rlVertex3f(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+    }
+  }
+  rlEnd();
+  auto end = std::chrono::steady_clock::now();
+
+  rlPopMatrix();
+  rlSetRenderBatchActive(NULL);
+
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+void draw_submit(float angle) {
+  submit.single_ms += submit_vertices(false, angle);
+  submit.bulk_ms += submit_vertices(true, -angle);
+  submit.frames++;
+}
+
+void print_submit_stats() {
+  if (submit.frames == 0) {
+    return;
+  }
+
+  double vertices = (double)opts.submit * submit.frames;
+  printf("submit: %d vertices x %d frames\n", opts.submit, submit.frames);
+  printf("  rlVertex3f:      %8.3f ms/frame, %7.1f Mvertices/s\n",
+         submit.single_ms / submit.frames, vertices / submit.single_ms / 1e3);
+  printf("  rlVertexArray3f: %8.3f ms/frame, %7.1f Mvertices/s (%.2fx)\n",
+         submit.bulk_ms / submit.frames, vertices / submit.bulk_ms / 1e3,
+         submit.single_ms / submit.bulk_ms);
+}
+
+struct Sprite {
+  float x, y, size;
+  unsigned char color[4];
+};
+
+struct SpriteLayout {
+  const char *name;
+  rlRenderBatch batch;
+  double fill_ms;
+  double upload_ms;
+  double flush_ms;
+};
+
+struct Sprites {
+  std::vector<Sprite> sprites;
+  SpriteLayout layouts[2];
+  int frames;
+};
+
+Sprites sprites;
+
+void generate_sprites(std::vector<Sprite> &out, int count) {
+  out.resize(count);
+
+  srand(2);
+  for (Sprite &s : out) {
+    s.x = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    s.y = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    s.size = 0.005f + (float)rand() / RAND_MAX * 0.01f;
+    for (int c = 0; c < 3; c++) {
+      s.color[c] = (unsigned char)(rand() & 255);
+    }
+    s.color[3] = 255;
+  }
+}
+
+void submit_sprites(const std::vector<Sprite> &in) {
+  rlBegin(RL_QUADS);
+  for (const Sprite &s : in) {
+    rlColor4ub(s.color[0], s.color[1], s.color[2], s.color[3]);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex2f(s.x, s.y);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex2f(s.x, s.y - s.size);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex2f(s.x + s.size, s.y - s.size);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex2f(s.x + s.size, s.y);
+  }
+  rlEnd();
+}
+
+void init_sprites() {
+  generate_sprites(sprites.sprites, opts.sprites);
+
+  sprites.layouts[0].name = "separate";
+  sprites.layouts[0].batch = rlLoadRenderBatch(2, opts.sprites + 1);
+  sprites.layouts[1].name = "interleaved";
+  sprites.layouts[1].batch = rlLoadRenderBatchInterleaved(2, opts.sprites + 1);
+}
+
+void draw_sprites(SpriteLayout &layout) {
+  rlSetRenderBatchActive(&layout.batch);
+
+  auto begin = std::chrono::steady_clock::now();
+  submit_sprites(sprites.sprites);
+  auto filled = std::chrono::steady_clock::now();
+
+  // the same uploads rlDrawRenderBatch is about to do, on their own
+  const rlVertexBuffer &buffer =
+      layout.batch.vertexBuffer[layout.batch.currentBuffer];
+  int vertices = opts.sprites * 4;
+  if (buffer.interleaved) {
+    rlUpdateVertexBuffer(buffer.vboId[0], buffer.interleaved,
+                         vertices * sizeof(rlVertex), 0);
+  } else {
+    rlUpdateVertexBuffer(buffer.vboId[0], buffer.vertices,
+                         vertices * 3 * sizeof(float), 0);
+    rlUpdateVertexBuffer(buffer.vboId[1], buffer.texcoords,
+                         vertices * 2 * sizeof(float), 0);
+    rlUpdateVertexBuffer(buffer.vboId[2], buffer.colors, vertices * 4, 0);
+  }
+  auto uploaded = std::chrono::steady_clock::now();
+
+  rlDrawRenderBatchActive();
+  auto flushed = std::chrono::steady_clock::now();
+
+  rlSetRenderBatchActive(NULL);
+
+  layout.fill_ms +=
+      std::chrono::duration<double, std::milli>(filled - begin).count();
+  layout.upload_ms +=
+      std::chrono::duration<double, std::milli>(uploaded - filled).count();
+  layout.flush_ms +=
+      std::chrono::duration<double, std::milli>(flushed - uploaded).count();
+}
+
+void print_sprite_stats() {
+  if (sprites.frames == 0) {
+    return;
+  }
+
+  printf("sprites: %d quads x %d frames, %d bytes per vertex\n", opts.sprites,
+         sprites.frames, (int)sizeof(rlVertex));
+  for (const SpriteLayout &layout : sprites.layouts) {
+    printf("  %-12s fill %8.3f, upload %8.3f, flush %8.3f ms/frame\n",
+           layout.name, layout.fill_ms / sprites.frames,
+           layout.upload_ms / sprites.frames, layout.flush_ms / sprites.frames);
+  }
+}
+
+const int FLUSH_BUFFERS[] = {1, 2, 3};
+const int FLUSH_BATCHES = sizeof(FLUSH_BUFFERS) / sizeof(FLUSH_BUFFERS[0]);
+
+struct FlushBatch {
+  rlRenderBatch batch;
+  double submit_ms;
+  double total_ms;
+  double worst_ms;
+  int flushes;
+};
+
+struct Flush {
+  std::vector<Sprite> sprites;
+  FlushBatch batches[FLUSH_BATCHES];
+  int frames;
+};
+
+Flush flush;
+
+void init_flush() {
+  generate_sprites(flush.sprites, opts.flush);
+
+  for (int i = 0; i < FLUSH_BATCHES; i++) {
+    flush.batches[i].batch =
+        rlLoadRenderBatch(FLUSH_BUFFERS[i], RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+  }
+}
+
+void draw_flush(int frame) {
+  for (int i = 0; i < FLUSH_BATCHES; i++) {
+    // rotate the order, so no batch always follows the same one
+    FlushBatch &b = flush.batches[(frame + i) % FLUSH_BATCHES];
+    rlSetRenderBatchActive(&b.batch);
+
+    // start from an idle GPU, so no batch pays for the one before it, and
+    // finish at the end: where the driver rasterizes (during the submit, at
+    // a fence or later) then no longer changes what is timed
+    rlFinish();
+    rlBatchStats before = rlGetBatchStats();
+
+    auto begin = std::chrono::steady_clock::now();
+    submit_sprites(flush.sprites);
+    rlDrawRenderBatchActive();
+    auto submitted = std::chrono::steady_clock::now();
+    rlFinish();
+    auto end = std::chrono::steady_clock::now();
+
+    rlSetRenderBatchActive(NULL);
+
+    rlBatchStats after = rlGetBatchStats();
+    b.flushes += after.flushes[RL_FLUSH_BUFFER_FULL] -
+                 before.flushes[RL_FLUSH_BUFFER_FULL] +
+                 after.flushes[RL_FLUSH_EXPLICIT] -
+                 before.flushes[RL_FLUSH_EXPLICIT];
+
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    b.submit_ms +=
+        std::chrono::duration<double, std::milli>(submitted - begin).count();
+    b.total_ms += ms;
+    b.worst_ms = ms > b.worst_ms ? ms : b.worst_ms;
+  }
+  flush.frames++;
+}
+
+void print_flush_stats() {
+  if (flush.frames == 0) {
+    return;
+  }
+
+  printf("flush: %d quads x %d frames, %d quads per batch buffer\n",
+         opts.flush, flush.frames, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+  for (int i = 0; i < FLUSH_BATCHES; i++) {
+    const FlushBatch &b = flush.batches[i];
+    printf("  %d buffer(s): submit %8.3f, + glFinish %8.3f ms/frame (max "
+           "%8.3f), ",
+           FLUSH_BUFFERS[i], b.submit_ms / flush.frames,
+           b.total_ms / flush.frames, b.worst_ms);
+    if (FLUSH_BUFFERS[i] == 1) {
+      printf("%d flushes, not fenced\n", b.flushes);
+    } else {
+      printf("%5.1f%% of %d flushes waited on a fence\n",
+             100.0 * b.batch.fenceWaits / std::max(b.flushes, 1), b.flushes);
+    }
+  }
+}
+
+struct UiBatch {
+  const char *name;
+  rlRenderBatch batch;
+  double submit_ms;
+  double sort_ms;
+  double flush_ms;
+};
+
+struct Ui {
+  std::vector<Sprite> widgets;
+  unsigned int textures[3];
+  UiBatch batches[2];
+  int frames;
+};
+
+Ui ui;
+
+void init_ui() {
+  generate_sprites(ui.widgets, opts.ui);
+
+  // 2x2 textures: panel grey, icons red and blue
+  const unsigned char colors[3][4] = {
+      {200, 200, 200, 255}, {255, 64, 64, 255}, {64, 64, 255, 255}};
+  for (int t = 0; t < 3; t++) {
+    unsigned char pixels[2 * 2 * 4];
+    for (int p = 0; p < 4; p++) {
+      memcpy(&pixels[p * 4], colors[t], 4);
+    }
+    ui.textures[t] = rlLoadTexture(pixels, 2, 2,
+                                   RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+  }
+
+  ui.batches[0].name = "plain";
+  ui.batches[0].batch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+  ui.batches[1].name = "deferred";
+  ui.batches[1].batch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+  ui.batches[1].batch.deferred = true;
+}
+
+void ui_quad(unsigned int texture, float x, float y, float size) {
+  rlSetTexture(texture);
+  rlBegin(RL_QUADS);
+  rlColor4ub(255, 255, 255, 255);
+  rlTexCoord2f(0.0f, 0.0f);
+  rlVertex2f(x, y);
+  rlTexCoord2f(0.0f, 1.0f);
+  rlVertex2f(x, y - size);
+  rlTexCoord2f(1.0f, 1.0f);
+  rlVertex2f(x + size, y - size);
+  rlTexCoord2f(1.0f, 0.0f);
+  rlVertex2f(x + size, y);
+  rlEnd();
+  rlSetTexture(0);
+}
+
+void draw_ui(UiBatch &b) {
+  rlSetRenderBatchActive(&b.batch);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < opts.ui; i++) {
+    const Sprite &w = ui.widgets[i];
+    rlSetDrawLayer(0);
+    ui_quad(ui.textures[0], w.x, w.y, w.size * 2.0f);
+    rlSetDrawLayer(1);
+    ui_quad(ui.textures[1 + i % 2], w.x + w.size * 0.5f, w.y - w.size * 0.5f,
+            w.size);
+  }
+  auto submitted = std::chrono::steady_clock::now();
+  if (b.batch.deferred) {
+    rlSortRenderBatch(&b.batch);
+  }
+  auto sorted = std::chrono::steady_clock::now();
+  rlDrawRenderBatchActive();
+  auto flushed = std::chrono::steady_clock::now();
+
+  rlSetDrawLayer(0);
+  rlSetRenderBatchActive(NULL);
+
+  b.submit_ms +=
+      std::chrono::duration<double, std::milli>(submitted - begin).count();
+  b.sort_ms +=
+      std::chrono::duration<double, std::milli>(sorted - submitted).count();
+  b.flush_ms +=
+      std::chrono::duration<double, std::milli>(flushed - sorted).count();
+}
+
+void print_ui_stats() {
+  if (ui.frames == 0) {
+    return;
+  }
+
+  printf("ui: %d widgets x %d frames\n", opts.ui, ui.frames);
+  for (const UiBatch &b : ui.batches) {
+    printf("  %-8s %7.1f draws recorded, %7.1f issued per frame, submit "
+           "%7.3f ms, sort %6.3f ms, flush %7.3f ms\n",
+           b.name, (double)b.batch.drawsRecorded / ui.frames,
+           (double)b.batch.drawsIssued / ui.frames, b.submit_ms / ui.frames,
+           b.sort_ms / ui.frames, b.flush_ms / ui.frames);
+  }
+}
+
+// a hexagon of radius 1, as a fan of triangles around its center
+const int HEXAGON_VERTICES = 6 * 3;
+
+struct Instanced {
+  std::vector<Sprite> shapes;
+  std::vector<Matrix> transforms;
+  std::vector<unsigned char> colors;
+  float hexagon[HEXAGON_VERTICES * 3];
+  rlInstancedMesh mesh;
+  double immediate_ms;
+  double fill_ms;
+  double draw_ms;
+  int frames;
+};
+
+Instanced instanced;
+
+void init_instanced() {
+  int count = opts.instanced / (HEXAGON_VERTICES / 3);
+  generate_sprites(instanced.shapes, count);
+  instanced.transforms.resize(count);
+  instanced.colors.resize(count * 4);
+  for (int i = 0; i < count; i++) {
+    memcpy(&instanced.colors[i * 4], instanced.shapes[i].color, 4);
+  }
+
+  for (int t = 0; t < 6; t++) {
+    float *v = &instanced.hexagon[t * 9];
+    float a0 = t * 3.14159265f / 3.0f;
+    float a1 = (t + 1) * 3.14159265f / 3.0f;
+    v[0] = 0.0f, v[1] = 0.0f, v[2] = 0.0f;
+    v[3] = cosf(a0), v[4] = sinf(a0), v[5] = 0.0f;
+    v[6] = cosf(a1), v[7] = sinf(a1), v[8] = 0.0f;
+  }
+
+  instanced.mesh =
+      rlLoadInstancedMesh(instanced.hexagon, HEXAGON_VERTICES, count);
+  rlUpdateInstancedMesh(instanced.mesh, NULL, instanced.colors.data(), count);
+}
+
+// same as rlTranslatef(x, y, 0), rlRotatef(degrees, 0, 0, 1) and
+// rlScalef(size, size, 1) from identity
+Matrix shape_transform(const Sprite &s, float degrees) {
+  float c = cosf(degrees * 3.14159265f / 180.0f) * s.size;
+  float n = sinf(degrees * 3.14159265f / 180.0f) * s.size;
+
+  Matrix m = {};
+  m.m0 = c, m.m4 = -n, m.m12 = s.x;
+  m.m1 = n, m.m5 = c, m.m13 = s.y;
+  m.m10 = 1.0f;
+  m.m15 = 1.0f;
+  return m;
+}
+
+void draw_instanced(float angle) {
+  int count = (int)instanced.shapes.size();
+
+  // rlPushMatrix/rlTranslatef... only transform vertices on the CPU in
+  // modelview mode
+  rlMatrixMode(RL_MODELVIEW);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) {
+    const Sprite &s = instanced.shapes[i];
+    rlPushMatrix();
+    rlTranslatef(s.x, s.y, 0.0f);
+    rlRotatef(angle + i, 0.0f, 0.0f, 1.0f);
+    rlScalef(s.size, s.size, 1.0f);
+    rlBegin(RL_TRIANGLES);
+    rlColor4ub(s.color[0], s.color[1], s.color[2], s.color[3]);
+    for (int v = 0; v < HEXAGON_VERTICES; v++) {
+      const float *p = &instanced.hexagon[v * 3];
+      rlVertex3f(p[0], p[1], p[2]);
+    }
+    rlEnd();
+    rlPopMatrix();
+  }
+  rlDrawRenderBatchActive();
+  auto immediate = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < count; i++) {
+    instanced.transforms[i] = shape_transform(instanced.shapes[i], angle + i);
+  }
+  auto filled = std::chrono::steady_clock::now();
+  rlUpdateInstancedMesh(instanced.mesh, instanced.transforms.data(), NULL,
+                        count);
+  rlDrawInstancedMesh(instanced.mesh, count);
+  auto drawn = std::chrono::steady_clock::now();
+
+  instanced.immediate_ms +=
+      std::chrono::duration<double, std::milli>(immediate - begin).count();
+  instanced.fill_ms +=
+      std::chrono::duration<double, std::milli>(filled - immediate).count();
+  instanced.draw_ms +=
+      std::chrono::duration<double, std::milli>(drawn - filled).count();
+  instanced.frames++;
+}
+
+void print_instanced_stats() {
+  if (instanced.frames == 0) {
+    return;
+  }
+
+  int frames = instanced.frames;
+  int triangles = (int)instanced.shapes.size() * (HEXAGON_VERTICES / 3);
+  double instanced_ms = instanced.fill_ms + instanced.draw_ms;
+  printf("instanced: %d triangles (%d hexagons) x %d frames\n", triangles,
+         (int)instanced.shapes.size(), frames);
+  printf("  rlBegin/rlVertex3f: %8.3f ms/frame, %7.1f Mtriangles/s\n",
+         instanced.immediate_ms / frames,
+         (double)triangles * frames / instanced.immediate_ms / 1e3);
+  printf("  rlDrawInstancedMesh: %7.3f ms/frame, %7.1f Mtriangles/s (%.2fx), "
+         "transforms %.3f ms, upload and draw %.3f ms\n",
+         instanced_ms / frames, (double)triangles * frames / instanced_ms / 1e3,
+         instanced.immediate_ms / instanced_ms, instanced.fill_ms / frames,
+         instanced.draw_ms / frames);
+}
+
+const int ATLAS_SIZE = 2048;
+
+struct AtlasImage {
+  int width, height;
+  unsigned int texture;
+  int page;
+  rlAtlasRegion region;
+};
+
+struct AtlasPath {
+  const char *name;
+  rlRenderBatch batch;
+  double submit_ms;
+  double flush_ms;
+};
+
+struct Atlas {
+  std::vector<Sprite> sprites;
+  std::vector<AtlasImage> images;
+  std::vector<rlAtlas> pages;
+  std::vector<unsigned char> pixels;
+  AtlasPath paths[2];
+  double pack_ms;
+  double churn_ms;
+  int frames;
+};
+
+Atlas atlas;
+
+// solid color with a darker 1 pixel border, so bleeding shows
+const unsigned char *atlas_pixels(const Sprite &s, int width, int height) {
+  atlas.pixels.resize(width * height * 4);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+      unsigned char *p = &atlas.pixels[(y * width + x) * 4];
+      for (int c = 0; c < 3; c++) {
+        p[c] = border ? s.color[c] / 2 : s.color[c];
+      }
+      p[3] = 255;
+    }
+  }
+  return atlas.pixels.data();
+}
+
+// packs image i into the page it was on if it still fits, otherwise into the
+// last page or a new one, and returns how long that took. Filling pages in
+// order keeps consecutive sprites on the same page, so in the same draw.
+double atlas_insert(int i) {
+  AtlasImage &image = atlas.images[i];
+  const unsigned char *pixels =
+      atlas_pixels(atlas.sprites[i], image.width, image.height);
+
+  auto begin = std::chrono::steady_clock::now();
+  bool packed = image.page >= 0 &&
+                rlAtlasInsert(&atlas.pages[image.page], pixels, image.width,
+                              image.height, &image.region);
+  int last = (int)atlas.pages.size() - 1;
+  if (!packed && last >= 0 && last != image.page &&
+      rlAtlasInsert(&atlas.pages[last], pixels, image.width, image.height,
+                    &image.region)) {
+    image.page = last;
+    packed = true;
+  }
+  if (!packed) {
+    atlas.pages.push_back(rlLoadAtlas(ATLAS_SIZE, ATLAS_SIZE, 1, true));
+    image.page = (int)atlas.pages.size() - 1;
+    rlAtlasInsert(&atlas.pages.back(), pixels, image.width, image.height,
+                  &image.region);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+void init_atlas() {
+  generate_sprites(atlas.sprites, opts.atlas);
+  atlas.images.resize(opts.atlas);
+
+  for (int i = 0; i < opts.atlas; i++) {
+    AtlasImage &image = atlas.images[i];
+    image.width = 8 + rand() % 57;
+    image.height = 8 + rand() % 57;
+    image.texture = rlLoadTexture(
+        atlas_pixels(atlas.sprites[i], image.width, image.height),
+        image.width, image.height, RL_PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+    image.page = -1;
+  }
+
+  for (int i = 0; i < opts.atlas; i++) {
+    atlas.pack_ms += atlas_insert(i);
+  }
+
+  // one element is a quad, big enough to never run out of vertices
+  atlas.paths[0].name = "textures";
+  atlas.paths[0].batch = rlLoadRenderBatch(1, opts.atlas + 1);
+  atlas.paths[1].name = "atlas";
+  atlas.paths[1].batch = rlLoadRenderBatch(1, opts.atlas + 1);
+}
+
+void atlas_quad(const Sprite &s, const AtlasImage &image) {
+  float w = image.width * 0.001f;
+  float h = image.height * 0.001f;
+
+  rlBegin(RL_QUADS);
+  rlColor4ub(255, 255, 255, 255);
+  rlTexCoord2f(0.0f, 0.0f);
+  rlVertex2f(s.x, s.y);
+  rlTexCoord2f(0.0f, 1.0f);
+  rlVertex2f(s.x, s.y - h);
+  rlTexCoord2f(1.0f, 1.0f);
+  rlVertex2f(s.x + w, s.y - h);
+  rlTexCoord2f(1.0f, 0.0f);
+  rlVertex2f(s.x + w, s.y);
+  rlEnd();
+}
+
+void draw_atlas_path(AtlasPath &path, bool packed) {
+  rlSetRenderBatchActive(&path.batch);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < opts.atlas; i++) {
+    const AtlasImage &image = atlas.images[i];
+    if (packed) {
+      const rlAtlasRegion &r = image.region;
+      rlSetTextureRegion(atlas.pages[image.page].id, r.u0, r.v0, r.u1, r.v1);
+    } else {
+      rlSetTexture(image.texture);
+    }
+    atlas_quad(atlas.sprites[i], image);
+    rlSetTexture(0);
+  }
+  auto submitted = std::chrono::steady_clock::now();
+  rlDrawRenderBatchActive();
+  auto flushed = std::chrono::steady_clock::now();
+
+  rlSetRenderBatchActive(NULL);
+
+  path.submit_ms +=
+      std::chrono::duration<double, std::milli>(submitted - begin).count();
+  path.flush_ms +=
+      std::chrono::duration<double, std::milli>(flushed - submitted).count();
+}
+
+void draw_atlas(int frame) {
+  // evict 1% of the packed images and insert them again with a new size
+  int churn = std::max(1, opts.atlas / 100);
+  for (int k = 0; k < churn; k++) {
+    int i = (frame * churn + k) % opts.atlas;
+    AtlasImage &image = atlas.images[i];
+
+    auto begin = std::chrono::steady_clock::now();
+    rlAtlasEvict(&atlas.pages[image.page], image.region);
+    auto end = std::chrono::steady_clock::now();
+    atlas.churn_ms +=
+        std::chrono::duration<double, std::milli>(end - begin).count();
+
+    image.width = 8 + (i + frame) % 57;
+    image.height = 8 + (i * 7 + frame) % 57;
+    atlas.churn_ms += atlas_insert(i);
+  }
+
+  draw_atlas_path(atlas.paths[frame % 2], frame % 2 == 1);
+  draw_atlas_path(atlas.paths[1 - frame % 2], frame % 2 == 0);
+  atlas.frames++;
+}
+
+void print_atlas_stats() {
+  if (atlas.frames == 0) {
+    return;
+  }
+
+  int frames = atlas.frames;
+  long used = 0;
+  for (const rlAtlas &page : atlas.pages) {
+    used += page.usedArea;
+  }
+
+  printf("atlas: %d images x %d frames, packed and uploaded in %.3f ms "
+         "(%.2f us per image)\n",
+         opts.atlas, frames, atlas.pack_ms, atlas.pack_ms * 1000.0 / opts.atlas);
+  printf("  %d page(s) of %dx%d, %.1f%% used, evict + insert %d images "
+         "%.3f ms/frame\n",
+         (int)atlas.pages.size(), ATLAS_SIZE, ATLAS_SIZE,
+         100.0 * used / ((double)atlas.pages.size() * ATLAS_SIZE * ATLAS_SIZE),
+         std::max(1, opts.atlas / 100), atlas.churn_ms / frames);
+  for (const AtlasPath &path : atlas.paths) {
+    printf("  %-8s %7.1f draws per frame, submit %7.3f ms, flush %7.3f ms\n",
+           path.name, (double)path.batch.drawsIssued / frames,
+           path.submit_ms / frames, path.flush_ms / frames);
+  }
+}
+
+// sequences checked against the scalar path every frame
+const int MATRIX_CHECKS = 1024;
+
+// full 4x4 matrix math in scalar code, m[N] is Matrix element mN
+struct MatrixRef {
+  float m[16];
+};
+
+struct MatrixStack {
+  std::vector<Sprite> shapes;
+  std::vector<MatrixRef> expected;
+  rlRenderBatch batch;
+  double rlgl_ms;
+  double scalar_ms;
+  float matrix_error;
+  float vertex_error;
+  float sink;
+  int frames;
+};
+
+MatrixStack matrix;
+
+MatrixRef ref_identity() {
+  MatrixRef r = {};
+  r.m[0] = r.m[5] = r.m[10] = r.m[15] = 1.0f;
+  return r;
+}
+
+MatrixRef ref_multiply(const MatrixRef &l, const MatrixRef &r) {
+  MatrixRef o;
+  for (int i = 0; i < 16; i += 4) {
+    for (int j = 0; j < 4; j++) {
+      o.m[i + j] = l.m[i] * r.m[j] + l.m[i + 1] * r.m[4 + j] +
+                   l.m[i + 2] * r.m[8 + j] + l.m[i + 3] * r.m[12 + j];
+    }
+  }
+  return o;
+}
+
+// rlTranslatef(x, y, 0), rlRotatef(degrees, 0, 0, 1), rlScalef(size, size,
+// 1), built and composed the way rlgl does it
+MatrixRef ref_transform(MatrixRef m, const Sprite &s, float degrees) {
+  MatrixRef t = ref_identity();
+  t.m[12] = s.x, t.m[13] = s.y;
+  m = ref_multiply(t, m);
+
+  float c = cosf(DEG2RAD * degrees);
+  float n = sinf(DEG2RAD * degrees);
+  MatrixRef r = ref_identity();
+  r.m[0] = c, r.m[1] = n;
+  r.m[4] = -n, r.m[5] = c;
+  m = ref_multiply(r, m);
+
+  MatrixRef k = ref_identity();
+  k.m[0] = s.size, k.m[5] = s.size;
+  return ref_multiply(k, m);
+}
+
+// element mN of a Matrix, whose fields are laid out m0, m4, m8, m12, m1...
+float matrix_at(const Matrix &m, int n) {
+  return (&m.m0)[n % 4 * 4 + n / 4];
+}
+
+const float MATRIX_TRIANGLE[9] = {0.0f, 1.0f,  0.0f, -1.0f, -1.0f,
+                                  0.0f, 1.0f, -1.0f, 0.0f};
+
+void init_matrix() {
+  generate_sprites(matrix.shapes, opts.matrix);
+  matrix.expected.resize(std::min(opts.matrix, MATRIX_CHECKS));
+  matrix.batch = rlLoadRenderBatch(1, MATRIX_CHECKS * 3 / 4 + 2);
+}
+
+void check_matrix(float angle) {
+  int count = (int)matrix.expected.size();
+
+  rlSetRenderBatchActive(&matrix.batch);
+  rlBegin(RL_TRIANGLES);
+  for (int i = 0; i < count; i++) {
+    const Sprite &s = matrix.shapes[i];
+    rlPushMatrix();
+    rlTranslatef(s.x, s.y, 0.0f);
+    rlRotatef(angle + i, 0.0f, 0.0f, 1.0f);
+    rlScalef(s.size, s.size, 1.0f);
+
+    MatrixRef &e = matrix.expected[i];
+    e = ref_transform(ref_identity(), s, angle + i);
+    Matrix m = rlGetMatrixTransform();
+    for (int n = 0; n < 16; n++) {
+      matrix.matrix_error =
+          std::max(matrix.matrix_error, fabsf(matrix_at(m, n) - e.m[n]));
+    }
+
+    rlColor4ub(s.color[0], s.color[1], s.color[2], s.color[3]);
+    for (int v = 0; v < 3; v++) {
+      rlVertex3f(MATRIX_TRIANGLE[v * 3], MATRIX_TRIANGLE[v * 3 + 1],
+                 MATRIX_TRIANGLE[v * 3 + 2]);
+    }
+    rlPopMatrix();
+  }
+  rlEnd();
+
+  // the batch was drawn last frame, so this frame's vertices start at 0
+  const float *vertices = matrix.batch.vertexBuffer[0].vertices;
+  for (int i = 0; i < count; i++) {
+    const MatrixRef &e = matrix.expected[i];
+    for (int v = 0; v < 3; v++) {
+      const float *p = &MATRIX_TRIANGLE[v * 3];
+      const float *q = &vertices[(i * 3 + v) * 3];
+      for (int c = 0; c < 3; c++) {
+        float t = e.m[c] * p[0] + e.m[4 + c] * p[1] + e.m[8 + c] * p[2] +
+                  e.m[12 + c];
+        matrix.vertex_error = std::max(matrix.vertex_error, fabsf(q[c] - t));
+      }
+    }
+  }
+  rlSetRenderBatchActive(NULL);
+}
+
+void draw_matrix(float angle) {
+  int count = opts.matrix;
+
+  // the matrix stack only composes into the transform in modelview mode
+  rlMatrixMode(RL_MODELVIEW);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < count; i++) {
+    const Sprite &s = matrix.shapes[i];
+    rlPushMatrix();
+    rlTranslatef(s.x, s.y, 0.0f);
+    rlRotatef(angle + i, 0.0f, 0.0f, 1.0f);
+    rlScalef(s.size, s.size, 1.0f);
+    rlPopMatrix();
+  }
+  auto pushed = std::chrono::steady_clock::now();
+
+  MatrixRef top = ref_identity();
+  float sink = 0.0f;
+  for (int i = 0; i < count; i++) {
+    MatrixRef m = ref_transform(top, matrix.shapes[i], angle + i);
+    sink += m.m[12];
+  }
+  auto scalar = std::chrono::steady_clock::now();
+  matrix.sink += sink;
+
+  check_matrix(angle);
+
+  matrix.rlgl_ms +=
+      std::chrono::duration<double, std::milli>(pushed - begin).count();
+  matrix.scalar_ms +=
+      std::chrono::duration<double, std::milli>(scalar - pushed).count();
+  matrix.frames++;
+}
+
+void print_matrix_stats() {
+  if (matrix.frames == 0) {
+    return;
+  }
+
+  int frames = matrix.frames;
+  double sequences = (double)opts.matrix * frames;
+  printf("matrix: %d push/translate/rotate/scale/pop x %d frames\n",
+         opts.matrix, frames);
+  printf("  rlgl:   %8.3f ms/frame, %7.1f Msequences/s (%.2fx)\n",
+         matrix.rlgl_ms / frames, sequences / matrix.rlgl_ms / 1e3,
+         matrix.scalar_ms / matrix.rlgl_ms);
+  printf("  scalar: %8.3f ms/frame, %7.1f Msequences/s\n",
+         matrix.scalar_ms / frames, sequences / matrix.scalar_ms / 1e3);
+  printf("  max difference over %d sequences/frame: transform %g, vertex %g "
+         "(checksum %g)\n",
+         (int)matrix.expected.size(), matrix.matrix_error, matrix.vertex_error,
+         matrix.sink);
+}
+
+std::vector<rlBatchStats> batch_stats;
+
+void print_batch_stats() {
+  if (batch_stats.empty()) {
+    return;
+  }
+
+  const char *causes[RL_FLUSH_CAUSE_COUNT] = {"explicit", "buffer full",
+                                              "draw limit", "state change"};
+
+  rlBatchStats total = {};
+  size_t slowest = 0;
+  for (size_t i = 0; i < batch_stats.size(); i++) {
+    const rlBatchStats &s = batch_stats[i];
+    for (int c = 0; c < RL_FLUSH_CAUSE_COUNT; c++) {
+      total.flushes[c] += s.flushes[c];
+    }
+    total.vertices += s.vertices;
+    total.maxVertices = std::max(total.maxVertices, s.maxVertices);
+    total.drawCalls += s.drawCalls;
+    total.drawTime += s.drawTime;
+    if (s.maxDrawTime > total.maxDrawTime) {
+      total.maxDrawTime = s.maxDrawTime;
+    }
+    if (s.drawTime > batch_stats[slowest].drawTime) {
+      slowest = i;
+    }
+  }
+
+  auto print = [&](const char *label, const rlBatchStats &s, double frames) {
+    int flushes = 0;
+    printf("  %-8s flushes", label);
+    for (int c = 0; c < RL_FLUSH_CAUSE_COUNT; c++) {
+      printf("%s %s %.1f", c == 0 ? "" : ",", causes[c], s.flushes[c] / frames);
+      flushes += s.flushes[c];
+    }
+    printf("\n           %.0f vertices per flush (max %d), %.1f draw calls, "
+           "rlDrawRenderBatch %.3f ms (slowest call %.3f ms)\n",
+           flushes > 0 ? (double)s.vertices / flushes : 0.0, s.maxVertices,
+           s.drawCalls / frames, s.drawTime * 1000.0 / frames,
+           s.maxDrawTime * 1000.0);
+  };
+
+  double frames = (double)batch_stats.size();
+  printf("batch stats: %d frames\n", (int)batch_stats.size());
+  print("average", total, frames);
+
+  char label[32];
+  snprintf(label, sizeof(label), "frame %d", (int)slowest);
+  print(label, batch_stats[slowest], 1.0);
+}
+
+int main(int argc, char **argv) {
+  if (!parse_options(argc, argv)) {
+    fprintf(stderr, usage, argv[0]);
+    return 1;
+  }
+
+#if defined(RLGL_SDL2)
+  if (opts.headless && opts.frames == 0) {
+    opts.frames = 300;
+  }
+#endif
+
   SetConfigFlags(FLAG_WINDOW_RESIZABLE);
-  InitWindow(800, 600, "raylib + rlgl");
+  InitWindow(opts.width, opts.height, "raylib + rlgl");
+
+  if (opts.submit > 0) {
+    init_submit();
+  }
+  if (opts.sprites > 0) {
+    init_sprites();
+  }
+  if (opts.flush > 0) {
+    init_flush();
+  }
+  if (opts.ui > 0) {
+    init_ui();
+  }
+  if (opts.instanced > 0) {
+    init_instanced();
+  }
+  if (opts.atlas > 0) {
+    init_atlas();
+  }
+  if (opts.matrix > 0) {
+    init_matrix();
+  }
+
+  int frame = 0;
+  while (!WindowShouldClose() && (opts.frames == 0 || frame < opts.frames)) {
+    if (opts.stats) {
+      rlResetBatchStats();
+    }
 
-  while (!WindowShouldClose()) {
     BeginDrawing();
     ClearBackground({128, 128, 128, 255});
 
     rlMatrixMode(RL_PROJECTION);
     rlLoadIdentity();
 
+    if (opts.submit > 0) {
+      draw_submit((float)frame);
+    }
+
+    if (opts.sprites > 0) {
+      // alternate which layout goes first, so neither always inherits the
+      // other one's GPU work
+      draw_sprites(sprites.layouts[frame % 2]);
+      draw_sprites(sprites.layouts[1 - frame % 2]);
+      sprites.frames++;
+    }
+
+    if (opts.flush > 0) {
+      draw_flush(frame);
+    }
+
+    if (opts.ui > 0) {
+      draw_ui(ui.batches[frame % 2]);
+      draw_ui(ui.batches[1 - frame % 2]);
+      ui.frames++;
+    }
+
+    if (opts.instanced > 0) {
+      draw_instanced((float)frame);
+    }
+
+    if (opts.atlas > 0) {
+      draw_atlas(frame);
+    }
+
+    if (opts.matrix > 0) {
+      draw_matrix((float)frame);
+    }
+
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+
     rlBegin(RL_TRIANGLES);
     rlColor4f(1.0f, 0.0f, 0.0f, 1.0f);
     rlVertex3f(+0.0f, +0.5f, 0.0f);
@@ -24,5 +1316,61 @@ int main() {
     rlEnd();
 
     EndDrawing();
+    if (opts.stats) {
+      batch_stats.push_back(rlGetBatchStats());
+    }
+    frame++;
+  }
+
+  if (opts.submit > 0) {
+    print_submit_stats();
+    rlUnloadRenderBatch(submit.batch);
+  }
+  if (opts.sprites > 0) {
+    print_sprite_stats();
+    rlUnloadRenderBatch(sprites.layouts[0].batch);
+    rlUnloadRenderBatch(sprites.layouts[1].batch);
+  }
+  if (opts.flush > 0) {
+    print_flush_stats();
+    for (FlushBatch &b : flush.batches) {
+      rlUnloadRenderBatch(b.batch);
+    }
+  }
+  if (opts.ui > 0) {
+    print_ui_stats();
+    for (UiBatch &b : ui.batches) {
+      rlUnloadRenderBatch(b.batch);
+    }
+    for (unsigned int texture : ui.textures) {
+      rlUnloadTexture(texture);
+    }
+  }
+  if (opts.instanced > 0) {
+    print_instanced_stats();
+    rlUnloadInstancedMesh(instanced.mesh);
+  }
+  if (opts.atlas > 0) {
+    print_atlas_stats();
+    for (AtlasPath &path : atlas.paths) {
+      rlUnloadRenderBatch(path.batch);
+    }
+    for (rlAtlas &page : atlas.pages) {
+      rlUnloadAtlas(page);
+    }
+    for (AtlasImage &image : atlas.images) {
+      rlUnloadTexture(image.texture);
+    }
+  }
+  if (opts.matrix > 0) {
+    print_matrix_stats();
+    rlUnloadRenderBatch(matrix.batch);
+  }
+  if (opts.stats) {
+    print_batch_stats();
   }
-}
\ No newline at end of file
+#if defined(RLGL_SDL2)
+  print_percentiles("frame", &platform.frame_ms);
+#endif
+  CloseWindow();
+}
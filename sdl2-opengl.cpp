@@ -1,121 +1,1532 @@
 // cl /std:c++17 /nologo /Zi /Iinclude sdl2-opengl.cpp lib/sdl2.lib lib/sdl2main.lib
+// g++ -std=c++17 -O2 -Iinclude sdl2-opengl.cpp -o sdl2-opengl -lSDL2 -lEGL
+//
+// sdl2-opengl [--headless] [--frames N] [--draws N] [--size WxH] [--dump out.ppm]
+//             [--capture out.ppm] [--capture-buffers N]
+//             [--no-state-cache] [--verify-state]
+//             [--render-thread] [--queue-depth N] [--compute N] [--sync-timing]
+//
+// --headless          FBO on a surfaceless EGL context (Linux only)
+// --frames N          close after N frames
+// --draws N           N draws per frame
+// --size WxH          window or FBO size
+// --dump out.ppm      save the last frame
+// --capture out.ppm   every frame as concatenated PPMs through async PBO
+//                     readback (--capture-buffers N), after a baseline run
+//                     of the same length when --frames is given
+// --no-state-cache    issue every GL state call, even redundant ones
+// --verify-state      check the GL state shadow against glGet* every frame
+// --render-thread     GL on its own thread, fed through a --queue-depth N
+//                     packet queue (not with --capture)
+// --compute N         N instances moved by a compute shader (GL 4.3)
+// --sync-timing       glFinish after --compute sim and draw, timed on the CPU
 
 #define SDL_MAIN_HANDLED
 #define GLAD_GL_IMPLEMENTATION
 
 #include <SDL2/SDL.h>
-#include <glad/gl.h>
 
-int main() {
-  SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
+// EGL has to come before glad, which otherwise provides its own copy of
+// khrplatform.h without the KHRONOS_APIENTRY that the EGL headers rely on
+#if defined(__linux__)
+#define HAS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
 
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+#include <glad/gl.h>
+#include <bench.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
 
+struct Options {
+  bool headless = false;
+  int frames = 0; // 0 runs until the window is closed
+  int draws = 1;
   int width = 800, height = 600;
-  SDL_Window *window = SDL_CreateWindow(
-      "SDL2 + OpenGL", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width,
-      height, SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL);
+  const char *dump = nullptr;
+  const char *capture = nullptr;
+  int capture_buffers = 3;
+  bool state_cache = true;
+  bool verify_state = false;
+  bool render_thread = false;
+  int queue_depth = 2;
+  int compute = 0;
+  bool sync_timing = false;
+};
+
+static bool parse_options(int argc, char **argv, Options *opts) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (strcmp(arg, "--headless") == 0) {
+      opts->headless = true;
+    } else if (strcmp(arg, "--frames") == 0 && next) {
+      opts->frames = atoi(next);
+      i++;
+    } else if (strcmp(arg, "--draws") == 0 && next) {
+      opts->draws = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--size") == 0 && next) {
+      if (sscanf(next, "%dx%d", &opts->width, &opts->height) != 2) {
+        return false;
+      }
+      i++;
+    } else if (strcmp(arg, "--dump") == 0 && next) {
+      opts->dump = next;
+      i++;
+    } else if (strcmp(arg, "--capture") == 0 && next) {
+      opts->capture = next;
+      i++;
+    } else if (strcmp(arg, "--capture-buffers") == 0 && next) {
+      opts->capture_buffers = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--no-state-cache") == 0) {
+      opts->state_cache = false;
+    } else if (strcmp(arg, "--verify-state") == 0) {
+      opts->verify_state = true;
+    } else if (strcmp(arg, "--render-thread") == 0) {
+      opts->render_thread = true;
+    } else if (strcmp(arg, "--queue-depth") == 0 && next) {
+      opts->queue_depth = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--compute") == 0 && next) {
+      opts->compute = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--sync-timing") == 0) {
+      opts->sync_timing = true;
+    } else {
+      return false;
+    }
+  }
+
+  if (opts->headless && opts->frames == 0) {
+    opts->frames = 1000;
+  }
+
+  if (opts->render_thread && opts->capture) {
+    fprintf(stderr, "--capture does not work with --render-thread\n");
+    return false;
+  }
+
+  return true;
+}
+
+#if defined(HAS_EGL)
+struct Headless {
+  HeadlessEgl egl;
+  GLuint fbo;
+  GLuint color;
+};
+
+// Frames go into an FBO, so the EGL surface (if any) is never drawn to.
+static bool create_headless(Headless *out, int major, int minor, int width,
+                            int height) {
+  *out = {};
+  if (!create_headless_egl(&out->egl, false, major, minor)) {
+    return false;
+  }
+
+  gladLoadGL((GLADloadfunc)eglGetProcAddress);
+
+  glGenRenderbuffers(1, &out->color);
+  glBindRenderbuffer(GL_RENDERBUFFER, out->color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenFramebuffers(1, &out->fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, out->fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, out->color);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf(stderr, "headless framebuffer is incomplete\n");
+    return false;
+  }
+
+  print_headless_egl(&out->egl, (const char *)glGetString(GL_RENDERER),
+                     (const char *)glGetString(GL_VERSION));
+  return true;
+}
+
+static void destroy_headless(Headless *h) {
+  glDeleteFramebuffers(1, &h->fbo);
+  glDeleteRenderbuffers(1, &h->color);
+  destroy_headless_egl(&h->egl);
+}
+#endif
+
+// Shadow copy of the GL state used by this file. It starts out holding the
+// GL defaults, so everything that changes this state has to go through the
+// state_* functions below or call state_reset() afterwards.
+enum StateBuffer {
+  STATE_ARRAY_BUFFER,
+  STATE_ELEMENT_ARRAY_BUFFER,
+  STATE_PIXEL_PACK_BUFFER,
+  STATE_UNIFORM_BUFFER,
+  STATE_BUFFER_COUNT,
+};
+
+struct GLState {
+  bool enabled;
+  bool verify;
+
+  GLuint program;
+  GLuint vao;
+  GLuint buffers[STATE_BUFFER_COUNT];
+  std::vector<GLuint> vao_element_buffers; // indexed by VAO name
+  GLint viewport[4];
+  GLfloat clear_color[4];
+  bool blend;
+  bool depth_test;
+  GLenum blend_src;
+  GLenum blend_dst;
+  GLenum depth_func;
+
+  int issued;
+  int elided;
+
+  long long frames;
+  long long total_issued;
+  long long total_elided;
+  long long mismatches;
+};
+
+static GLState g_state;
+
+static void state_reset() {
+  g_state.program = 0;
+  g_state.vao = 0;
+  memset(g_state.buffers, 0, sizeof(g_state.buffers));
+  g_state.vao_element_buffers.clear();
+  // the initial viewport is the size of the first surface, so it's unknown
+  g_state.viewport[2] = -1;
+  memset(g_state.clear_color, 0, sizeof(g_state.clear_color));
+  g_state.blend = false;
+  g_state.depth_test = false;
+  g_state.blend_src = GL_ONE;
+  g_state.blend_dst = GL_ZERO;
+  g_state.depth_func = GL_LESS;
+}
+
+static void state_init(bool enabled, bool verify) {
+  g_state = {};
+  g_state.enabled = enabled;
+  g_state.verify = verify;
+  state_reset();
+}
+
+// Returns true if a call needs to be issued, and counts it either way.
+static bool state_changed(bool changed) {
+  if (changed || !g_state.enabled) {
+    g_state.issued++;
+    return true;
+  }
+
+  g_state.elided++;
+  return false;
+}
+
+static int state_buffer_index(GLenum target) {
+  switch (target) {
+  case GL_ARRAY_BUFFER:
+    return STATE_ARRAY_BUFFER;
+  case GL_ELEMENT_ARRAY_BUFFER:
+    return STATE_ELEMENT_ARRAY_BUFFER;
+  case GL_PIXEL_PACK_BUFFER:
+    return STATE_PIXEL_PACK_BUFFER;
+  case GL_UNIFORM_BUFFER:
+    return STATE_UNIFORM_BUFFER;
+  default:
+    return -1;
+  }
+}
+
+static void state_use_program(GLuint program) {
+  if (state_changed(g_state.program != program)) {
+    glUseProgram(program);
+    g_state.program = program;
+  }
+}
+
+static void state_bind_vertex_array(GLuint vao) {
+  if (state_changed(g_state.vao != vao)) {
+    glBindVertexArray(vao);
+    g_state.vao = vao;
 
-  SDL_GL_CreateContext(window);
-  gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress);
+    // the element array binding is part of the VAO, and comes back as it was
+    // last bound with it, which for a new VAO is none
+    const std::vector<GLuint> &ebos = g_state.vao_element_buffers;
+    g_state.buffers[STATE_ELEMENT_ARRAY_BUFFER] =
+        vao < ebos.size() ? ebos[vao] : 0;
+  }
+}
+
+static void state_bind_buffer(GLenum target, GLuint buffer) {
+  int index = state_buffer_index(target);
+  if (index < 0) {
+    g_state.issued++;
+    glBindBuffer(target, buffer);
+  } else if (state_changed(g_state.buffers[index] != buffer)) {
+    glBindBuffer(target, buffer);
+    g_state.buffers[index] = buffer;
+
+    if (index == STATE_ELEMENT_ARRAY_BUFFER) {
+      std::vector<GLuint> &ebos = g_state.vao_element_buffers;
+      if (g_state.vao >= ebos.size()) {
+        ebos.resize(g_state.vao + 1);
+      }
+      ebos[g_state.vao] = buffer;
+    }
+  }
+}
+
+static void state_viewport(GLint x, GLint y, GLint width, GLint height) {
+  GLint *v = g_state.viewport;
+  if (state_changed(v[0] != x || v[1] != y || v[2] != width ||
+                    v[3] != height)) {
+    glViewport(x, y, width, height);
+    v[0] = x;
+    v[1] = y;
+    v[2] = width;
+    v[3] = height;
+  }
+}
+
+static void state_clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+  GLfloat *c = g_state.clear_color;
+  if (state_changed(c[0] != r || c[1] != g || c[2] != b || c[3] != a)) {
+    glClearColor(r, g, b, a);
+    c[0] = r;
+    c[1] = g;
+    c[2] = b;
+    c[3] = a;
+  }
+}
+
+static void state_enable(GLenum cap, bool on) {
+  bool *shadow = nullptr;
+  switch (cap) {
+  case GL_BLEND:
+    shadow = &g_state.blend;
+    break;
+  case GL_DEPTH_TEST:
+    shadow = &g_state.depth_test;
+    break;
+  }
+
+  if (shadow == nullptr) {
+    g_state.issued++;
+  } else if (state_changed(*shadow != on)) {
+    *shadow = on;
+  } else {
+    return;
+  }
+
+  if (on) {
+    glEnable(cap);
+  } else {
+    glDisable(cap);
+  }
+}
+
+static void state_blend_func(GLenum src, GLenum dst) {
+  if (state_changed(g_state.blend_src != src || g_state.blend_dst != dst)) {
+    glBlendFunc(src, dst);
+    g_state.blend_src = src;
+    g_state.blend_dst = dst;
+  }
+}
 
-  struct Vertex {
-    float position[3];
-    float color[4];
+static void state_depth_func(GLenum func) {
+  if (state_changed(g_state.depth_func != func)) {
+    glDepthFunc(func);
+    g_state.depth_func = func;
+  }
+}
+
+static int state_verify() {
+  int mismatches = 0;
+  auto check = [&](const char *name, GLint actual, GLint shadow) {
+    if (actual != shadow) {
+      fprintf(stderr, "state mismatch: %s is %d, shadow has %d\n", name,
+              actual, shadow);
+      mismatches++;
+    }
   };
 
+  GLint value = 0;
+  glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+  check("GL_CURRENT_PROGRAM", value, g_state.program);
+  glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+  check("GL_VERTEX_ARRAY_BINDING", value, g_state.vao);
+  glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &value);
+  check("GL_ARRAY_BUFFER_BINDING", value,
+        g_state.buffers[STATE_ARRAY_BUFFER]);
+  glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &value);
+  check("GL_ELEMENT_ARRAY_BUFFER_BINDING", value,
+        g_state.buffers[STATE_ELEMENT_ARRAY_BUFFER]);
+  glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &value);
+  check("GL_PIXEL_PACK_BUFFER_BINDING", value,
+        g_state.buffers[STATE_PIXEL_PACK_BUFFER]);
+  glGetIntegerv(GL_UNIFORM_BUFFER_BINDING, &value);
+  check("GL_UNIFORM_BUFFER_BINDING", value,
+        g_state.buffers[STATE_UNIFORM_BUFFER]);
+
+  if (g_state.viewport[2] >= 0) {
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    for (int i = 0; i < 4; i++) {
+      check("GL_VIEWPORT", viewport[i], g_state.viewport[i]);
+    }
+  }
+
+  GLfloat clear_color[4] = {};
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+  if (memcmp(clear_color, g_state.clear_color, sizeof(clear_color)) != 0) {
+    fprintf(stderr, "state mismatch: GL_COLOR_CLEAR_VALUE\n");
+    mismatches++;
+  }
+
+  check("GL_BLEND", glIsEnabled(GL_BLEND), g_state.blend);
+  check("GL_DEPTH_TEST", glIsEnabled(GL_DEPTH_TEST), g_state.depth_test);
+  glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+  check("GL_BLEND_SRC_RGB", value, g_state.blend_src);
+  glGetIntegerv(GL_BLEND_DST_RGB, &value);
+  check("GL_BLEND_DST_RGB", value, g_state.blend_dst);
+  glGetIntegerv(GL_DEPTH_FUNC, &value);
+  check("GL_DEPTH_FUNC", value, g_state.depth_func);
+
+  return mismatches;
+}
+
+static void state_end_frame() {
+  if (g_state.verify) {
+    g_state.mismatches += state_verify();
+  }
+
+  g_state.frames++;
+  g_state.total_issued += g_state.issued;
+  g_state.total_elided += g_state.elided;
+  g_state.issued = 0;
+  g_state.elided = 0;
+}
+
+static void print_state_stats() {
+  if (g_state.frames == 0) {
+    return;
+  }
+
+  printf("state calls/frame: %.1f issued, %.1f elided%s\n",
+         (double)g_state.total_issued / g_state.frames,
+         (double)g_state.total_elided / g_state.frames,
+         g_state.enabled ? "" : " (cache disabled)");
+  if (g_state.verify) {
+    printf("state verified every frame, %lld mismatches\n",
+           g_state.mismatches);
+  }
+}
+
+struct Vertex {
+  float position[3];
+  float color[4];
+};
+
+static GLuint create_triangle_vao() {
   GLuint vao = 0;
-  {
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+  glGenVertexArrays(1, &vao);
+  state_bind_vertex_array(vao);
 
-    Vertex vertices[] = {
-        {{+0.0f, +0.5f, 0.0f}, {1.0f, 0.0f, 0.0f, 1.0f}},
-        {{-0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}},
-        {{+0.5f, -0.5f, 0.0f}, {0.0f, 0.0f, 1.0f, 1.0f}},
-    };
+  Vertex vertices[] = {
+      {{+0.0f, +0.5f, 0.0f}, {1.0f, 0.0f, 0.0f, 1.0f}},
+      {{-0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}},
+      {{+0.5f, -0.5f, 0.0f}, {0.0f, 0.0f, 1.0f, 1.0f}},
+  };
 
-    GLuint vbo = 0;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+  GLuint vbo = 0;
+  glGenBuffers(1, &vbo);
+  state_bind_buffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          (void *)offsetof(Vertex, position));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void *)offsetof(Vertex, position));
+
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void *)offsetof(Vertex, color));
+
+  return vao;
+}
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          (void *)offsetof(Vertex, color));
+static void check_program(GLuint program) {
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    char log[1024] = {};
+    glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+    fprintf(stderr, "program link failed: %s\n", log);
   }
+}
 
+static GLuint create_program(const char *vert_glsl, const char *frag_glsl) {
   GLuint program = glCreateProgram();
+
+  GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(vs, 1, &vert_glsl, 0);
+  glCompileShader(vs);
+  glAttachShader(program, vs);
+
+  GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(fs, 1, &frag_glsl, 0);
+  glCompileShader(fs);
+  glAttachShader(program, fs);
+
+  glLinkProgram(program);
+  glDeleteShader(vs);
+  glDeleteShader(fs);
+
+  check_program(program);
+  return program;
+}
+
+static GLuint create_triangle_program() {
+  const char *vert_glsl = R"(
+    #version 330 core
+
+    layout(location=0) in vec3 a_position;
+    layout(location=1) in vec4 a_color;
+
+    out vec4 v_color;
+
+    void main() {
+      gl_Position = vec4(a_position, 1.0);
+      v_color = a_color;
+    }
+  )";
+
+  const char *frag_glsl = R"(
+    #version 330 core
+
+    in vec4 v_color;
+    out vec4 f_color;
+
+    void main() {
+      f_color = v_color;
+    }
+  )";
+
+  return create_program(vert_glsl, frag_glsl);
+}
+
+// Sets all the state it depends on every frame and binds for every draw, the
+// way a renderer with independent draw items does. The state shadow is what
+// keeps that cheap.
+static void draw_scene(GLuint program, GLuint vao, int width, int height,
+                       int draws) {
+  state_viewport(0, 0, width, height);
+  state_enable(GL_DEPTH_TEST, false);
+  state_depth_func(GL_LESS);
+  state_enable(GL_BLEND, false);
+  state_blend_func(GL_ONE, GL_ZERO);
+
+  state_clear_color(0.5f, 0.5f, 0.5f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  for (int i = 0; i < draws; i++) {
+    state_use_program(program);
+    state_bind_vertex_array(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
+}
+
+// Writes bottom-up RGBA pixels, as returned by glReadPixels, as a binary PPM
+// flipped so that the first row in the file is the top of the image.
+static void write_ppm(FILE *fd, const uint8_t *rgba, int width, int height) {
+  fprintf(fd, "P6\n%d %d\n255\n", width, height);
+  std::vector<uint8_t> row((size_t)width * 3);
+  for (int y = height - 1; y >= 0; y--) {
+    const uint8_t *src = &rgba[(size_t)y * width * 4];
+    for (int x = 0; x < width; x++) {
+      row[x * 3 + 0] = src[x * 4 + 0];
+      row[x * 3 + 1] = src[x * 4 + 1];
+      row[x * 3 + 2] = src[x * 4 + 2];
+    }
+    fwrite(row.data(), 1, row.size(), fd);
+  }
+}
+
+static bool dump_framebuffer(const char *file, int width, int height) {
+  std::vector<uint8_t> rgba((size_t)width * height * 4);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+  FILE *fd = fopen(file, "wb");
+  if (fd == nullptr) {
+    return false;
+  }
+
+  write_ppm(fd, rgba.data(), width, height);
+  fclose(fd);
+  return true;
+}
+
+// Frames are read into a ring of pixel pack buffers, each followed by a
+// fence. A buffer is mapped only after its fence has signaled, normally a few
+// frames later, and the copied pixels go to a writer thread. The frame only
+// blocks when the whole ring is still in flight or the writer falls behind.
+constexpr int CAPTURE_MAX_QUEUED = 16;
+
+struct CaptureSlot {
+  GLuint pbo;
+  GLsync fence;
+  GLsizeiptr size;
+  int width;
+  int height;
+};
+
+struct CaptureFrame {
+  std::vector<uint8_t> rgba;
+  int width;
+  int height;
+};
+
+struct Capture {
+  FILE *fd = nullptr;
+  std::vector<CaptureSlot> slots;
+  int next = 0;
+  int in_flight = 0;
+
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<CaptureFrame> queue;
+  std::vector<std::vector<uint8_t>> spare;
+  bool done = false;
+
+  int frames_read = 0;
+  int frames_written = 0;
+  int fence_stalls = 0;
+  int writer_stalls = 0;
+};
+
+static void capture_writer(Capture *cap) {
+  for (;;) {
+    CaptureFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(cap->mutex);
+      cap->cv.wait(lock, [&] { return !cap->queue.empty() || cap->done; });
+      if (cap->queue.empty()) {
+        return;
+      }
+
+      frame = std::move(cap->queue.front());
+      cap->queue.pop_front();
+    }
+    cap->cv.notify_all();
+
+    write_ppm(cap->fd, frame.rgba.data(), frame.width, frame.height);
+
+    std::lock_guard<std::mutex> lock(cap->mutex);
+    cap->frames_written++;
+    cap->spare.push_back(std::move(frame.rgba));
+  }
+}
+
+static bool start_capture(Capture *cap, const char *file, int buffers) {
+  cap->fd = fopen(file, "wb");
+  if (cap->fd == nullptr) {
+    return false;
+  }
+
+  cap->slots.resize(buffers);
+  for (CaptureSlot &slot : cap->slots) {
+    slot = {};
+    glGenBuffers(1, &slot.pbo);
+  }
+
+  cap->writer = std::thread(capture_writer, cap);
+  return true;
+}
+
+// Maps the oldest buffer in flight and queues its pixels for the writer.
+// Returns false without blocking if its fence hasn't signaled and !wait.
+static bool retire_oldest_capture(Capture *cap, bool wait) {
+  int count = (int)cap->slots.size();
+  CaptureSlot *slot = &cap->slots[(cap->next - cap->in_flight + count) % count];
+
+  GLenum res = glClientWaitSync(slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (res == GL_TIMEOUT_EXPIRED) {
+    if (!wait) {
+      return false;
+    }
+
+    cap->fence_stalls++;
+    do {
+      res = glClientWaitSync(slot->fence, 0, 1000000);
+    } while (res == GL_TIMEOUT_EXPIRED);
+  }
+
+  glDeleteSync(slot->fence);
+  slot->fence = nullptr;
+  cap->in_flight--;
+
+  CaptureFrame frame = {};
+  frame.width = slot->width;
+  frame.height = slot->height;
   {
-    const char *vert_glsl = R"(
-      #version 330 core
+    std::lock_guard<std::mutex> lock(cap->mutex);
+    if (!cap->spare.empty()) {
+      frame.rgba = std::move(cap->spare.back());
+      cap->spare.pop_back();
+    }
+  }
+  frame.rgba.resize(slot->size);
+
+  state_bind_buffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  void *src = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot->size,
+                               GL_MAP_READ_BIT);
+  if (src) {
+    memcpy(frame.rgba.data(), src, slot->size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  state_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  std::unique_lock<std::mutex> lock(cap->mutex);
+  if (cap->queue.size() >= CAPTURE_MAX_QUEUED) {
+    cap->writer_stalls++;
+    cap->cv.wait(lock, [&] { return cap->queue.size() < CAPTURE_MAX_QUEUED; });
+  }
+  cap->queue.push_back(std::move(frame));
+  lock.unlock();
+  cap->cv.notify_all();
+
+  return true;
+}
+
+// Queues an asynchronous read of the framebuffer that was just rendered.
+static void capture_frame(Capture *cap, int width, int height) {
+  while (cap->in_flight > 0 && retire_oldest_capture(cap, false)) {
+  }
+
+  if (cap->in_flight == (int)cap->slots.size()) {
+    retire_oldest_capture(cap, true);
+  }
+
+  CaptureSlot *slot = &cap->slots[cap->next];
+  GLsizeiptr size = (GLsizeiptr)width * height * 4;
+
+  state_bind_buffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  if (slot->size != size) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot->size = size;
+  }
+
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  state_bind_buffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot->width = width;
+  slot->height = height;
+
+  cap->next = (cap->next + 1) % (int)cap->slots.size();
+  cap->in_flight++;
+  cap->frames_read++;
+}
+
+static void finish_capture(Capture *cap) {
+  while (cap->in_flight > 0) {
+    retire_oldest_capture(cap, true);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(cap->mutex);
+    cap->done = true;
+  }
+  cap->cv.notify_all();
+  cap->writer.join();
+
+  for (CaptureSlot &slot : cap->slots) {
+    glDeleteBuffers(1, &slot.pbo);
+  }
+  fclose(cap->fd);
+}
+
+static void print_frame_stats(std::vector<double> *frame_ms,
+                              long long triangles_per_frame) {
+  if (frame_ms->empty()) {
+    return;
+  }
+
+  size_t frames = frame_ms->size();
+  printf("%zu frames, %lld triangles/frame\n", frames, triangles_per_frame);
+  double seconds = print_percentiles("frame", frame_ms) / 1000.0;
+  printf("%.1f fps, %.0f triangles/sec\n", frames / seconds,
+         triangles_per_frame * frames / seconds);
+}
+
+// GL 4.3 enums and entry points used by --compute. glad was generated for
+// 3.3 core, so these are loaded by hand once a 4.3 context exists.
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+
+typedef void(GLAD_API_PTR *PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x,
+                                                     GLuint num_groups_y,
+                                                     GLuint num_groups_z);
+typedef void(GLAD_API_PTR *PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+
+static PFNGLDISPATCHCOMPUTEPROC glDispatchCompute;
+static PFNGLMEMORYBARRIERPROC glMemoryBarrier;
+
+static bool load_gl43(GLADloadfunc load) {
+  glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+  glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+  return glDispatchCompute && glMemoryBarrier;
+}
+
+// Timer queries are read back this many frames after they were issued, so
+// that reading them doesn't wait for the GPU.
+constexpr int PARTICLE_QUERY_FRAMES = 4;
+constexpr int PARTICLE_GROUP_SIZE = 256;
+
+// Matches the std430 layout of Instance in the shaders below.
+struct ParticleInstance {
+  float position[4]; // xy, rotation, scale
+  float velocity[4]; // xy, angular velocity, unused
+  float color[4];
+};
+
+struct Particles {
+  int count;
+  bool sync_timing;
+  GLuint ssbo;
+  GLuint vao;
+  GLuint sim_program;
+  GLuint draw_program;
+  GLint dt_loc;
+  GLint count_loc;
+
+  GLuint queries[PARTICLE_QUERY_FRAMES][2];
+  long long frame;
+  std::vector<double> sim_ms;
+  std::vector<double> draw_ms;
+  std::vector<double> sync_sim_ms;
+  std::vector<double> sync_draw_ms;
+};
+
+static void create_particles(Particles *p, int count, bool sync_timing) {
+  *p = {};
+  p->count = count;
+  p->sync_timing = sync_timing;
+
+  const char *comp_glsl = R"(
+    #version 430 core
 
-      layout(location=0) in vec3 a_position;
-      layout(location=1) in vec4 a_color;
+    layout(local_size_x = 256) in;
 
-      out vec4 v_color;
+    struct Instance {
+      vec4 position;
+      vec4 velocity;
+      vec4 color;
+    };
+
+    layout(std430, binding = 0) buffer Instances {
+      Instance instances[];
+    };
+
+    uniform float u_dt;
+    uniform uint u_count;
+
+    void main() {
+      uint i = gl_GlobalInvocationID.x;
+      if (i >= u_count) {
+        return;
+      }
 
-      void main() {
-        gl_Position = vec4(a_position, 1.0);
-        v_color = a_color;
+      vec4 position = instances[i].position;
+      vec4 velocity = instances[i].velocity;
+
+      position.xy += velocity.xy * u_dt;
+      position.z += velocity.z * u_dt;
+
+      if (abs(position.x) > 1.0) {
+        position.x = clamp(position.x, -1.0, 1.0);
+        velocity.x = -velocity.x;
+      }
+      if (abs(position.y) > 1.0) {
+        position.y = clamp(position.y, -1.0, 1.0);
+        velocity.y = -velocity.y;
       }
-    )";
 
-    const char *frag_glsl = R"(
-      #version 330 core
+      instances[i].position = position;
+      instances[i].velocity = velocity;
+    }
+  )";
+
+  const char *vert_glsl = R"(
+    #version 430 core
+
+    struct Instance {
+      vec4 position;
+      vec4 velocity;
+      vec4 color;
+    };
+
+    layout(std430, binding = 0) readonly buffer Instances {
+      Instance instances[];
+    };
+
+    out vec4 v_color;
+
+    const vec2 corners[3] = vec2[3](
+      vec2(+0.0, +0.5), vec2(-0.5, -0.5), vec2(+0.5, -0.5));
+
+    void main() {
+      Instance inst = instances[gl_InstanceID];
+      vec2 corner = corners[gl_VertexID] * inst.position.w;
+      float s = sin(inst.position.z);
+      float c = cos(inst.position.z);
+      vec2 offset = vec2(corner.x * c - corner.y * s,
+                         corner.x * s + corner.y * c);
+
+      gl_Position = vec4(inst.position.xy + offset, 0.0, 1.0);
+      v_color = inst.color;
+    }
+  )";
+
+  const char *frag_glsl = R"(
+    #version 430 core
+
+    in vec4 v_color;
+    out vec4 f_color;
+
+    void main() {
+      f_color = v_color;
+    }
+  )";
+
+  p->sim_program = glCreateProgram();
+  {
+    GLuint cs = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(cs, 1, &comp_glsl, 0);
+    glCompileShader(cs);
+    glAttachShader(p->sim_program, cs);
+    glLinkProgram(p->sim_program);
+    glDeleteShader(cs);
+    check_program(p->sim_program);
+  }
+
+  p->draw_program = create_program(vert_glsl, frag_glsl);
+  p->dt_loc = glGetUniformLocation(p->sim_program, "u_dt");
+  p->count_loc = glGetUniformLocation(p->sim_program, "u_count");
+
+  // the only CPU pass over the instances, to seed them
+  std::vector<ParticleInstance> instances(count);
+  uint32_t seed = 1;
+  auto random = [&](float lo, float hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((seed >> 8) / 16777216.0f);
+  };
+
+  float scale = std::min(0.05f, 2.0f / sqrtf((float)count));
+  for (ParticleInstance &inst : instances) {
+    inst = {
+        {random(-1, 1), random(-1, 1), random(0, 6.28f), scale},
+        {random(-0.5f, 0.5f), random(-0.5f, 0.5f), random(-3, 3), 0},
+        {random(0, 1), random(0, 1), random(0, 1), 1},
+    };
+  }
+
+  glGenBuffers(1, &p->ssbo);
+  state_bind_buffer(GL_SHADER_STORAGE_BUFFER, p->ssbo);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               sizeof(ParticleInstance) * instances.size(), instances.data(),
+               GL_DYNAMIC_COPY);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, p->ssbo);
+
+  // core profile draws need a VAO even without vertex attributes
+  glGenVertexArrays(1, &p->vao);
+
+  glGenQueries(PARTICLE_QUERY_FRAMES * 2, &p->queries[0][0]);
+}
+
+static void read_particle_queries(Particles *p, int slot) {
+  GLuint64 sim_ns = 0;
+  GLuint64 draw_ns = 0;
+  glGetQueryObjectui64v(p->queries[slot][0], GL_QUERY_RESULT, &sim_ns);
+  glGetQueryObjectui64v(p->queries[slot][1], GL_QUERY_RESULT, &draw_ns);
+  p->sim_ms.push_back(sim_ns / 1e6);
+  p->draw_ms.push_back(draw_ns / 1e6);
+}
+
+static void draw_particles(Particles *p, int width, int height) {
+  int slot = (int)(p->frame % PARTICLE_QUERY_FRAMES);
+  if (p->frame >= PARTICLE_QUERY_FRAMES) {
+    read_particle_queries(p, slot);
+  }
+
+  state_viewport(0, 0, width, height);
+  state_enable(GL_DEPTH_TEST, false);
+  state_enable(GL_BLEND, false);
+
+  state_clear_color(0.5f, 0.5f, 0.5f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  auto since = [](std::chrono::steady_clock::time_point t) {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(now - t).count();
+  };
+
+  if (p->sync_timing) {
+    glFinish();
+  }
+  auto sim_begin = std::chrono::steady_clock::now();
+
+  glBeginQuery(GL_TIME_ELAPSED, p->queries[slot][0]);
+  state_use_program(p->sim_program);
+  glUniform1f(p->dt_loc, 1.0f / 60.0f);
+  glUniform1ui(p->count_loc, p->count);
+  glDispatchCompute((p->count + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE,
+                    1, 1);
+  glEndQuery(GL_TIME_ELAPSED);
+
+  if (p->sync_timing) {
+    glFinish();
+    p->sync_sim_ms.push_back(since(sim_begin));
+  }
+  auto draw_begin = std::chrono::steady_clock::now();
+
+  // the vertex shader reads what the compute shader just wrote
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+  glBeginQuery(GL_TIME_ELAPSED, p->queries[slot][1]);
+  state_use_program(p->draw_program);
+  state_bind_vertex_array(p->vao);
+  glDrawArraysInstanced(GL_TRIANGLES, 0, 3, p->count);
+  glEndQuery(GL_TIME_ELAPSED);
+
+  if (p->sync_timing) {
+    glFinish();
+    p->sync_draw_ms.push_back(since(draw_begin));
+  }
+
+  p->frame++;
+}
+
+static void print_particle_stats(Particles *p) {
+  long long first = std::max(p->frame - PARTICLE_QUERY_FRAMES, 0ll);
+  for (long long i = first; i < p->frame; i++) {
+    read_particle_queries(p, (int)(i % PARTICLE_QUERY_FRAMES));
+  }
+
+  if (p->sim_ms.empty()) {
+    return;
+  }
 
-      in vec4 v_color;
-      out vec4 f_color;
+  printf("%d instances, %.1f MB of instance data\n", p->count,
+         sizeof(ParticleInstance) * p->count / (1024.0 * 1024.0));
+  print_percentiles("timer query sim", &p->sim_ms);
+  print_percentiles("timer query draw", &p->draw_ms);
+  if (p->sync_timing) {
+    print_percentiles("synced sim", &p->sync_sim_ms);
+    print_percentiles("synced draw", &p->sync_draw_ms);
+  }
+}
+
+struct App {
+  const Options *opts;
+  SDL_Window *window;
+  SDL_GLContext context;
+#if defined(HAS_EGL)
+  Headless *headless;
+#endif
+  GLuint program;
+  GLuint vao;
+  Particles *particles;
+  int width;
+  int height;
+  GLsync present_fence;
+};
+
+static void draw_frame(App *app, int width, int height) {
+  if (app->particles) {
+    draw_particles(app->particles, width, height);
+  } else {
+    draw_scene(app->program, app->vao, width, height, app->opts->draws);
+  }
+}
+
+static long long triangles_per_frame(const App *app) {
+  return app->particles ? app->particles->count : app->opts->draws;
+}
+
+// Stands in for the swap when nothing is presented. A glFinish would drain the
+// GPU every frame, and with it every capture fence, so async readback would
+// look no different from a synchronous glReadPixels.
+static void present_headless(App *app) {
+  if (app->present_fence) {
+    glClientWaitSync(app->present_fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                     GL_TIMEOUT_IGNORED);
+    glDeleteSync(app->present_fence);
+  }
+
+  app->present_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+}
 
-      void main() {
-        f_color = v_color;
+// Draws until opts->frames frames have been added to frame_ms, or forever if
+// it is 0. Returns false if the window was closed first.
+static bool run_frames(App *app, Capture *capture,
+                       std::vector<double> *frame_ms) {
+  const Options *opts = app->opts;
+  size_t first = frame_ms->size();
+
+  for (;;) {
+    if (app->window) {
+      SDL_Event e = {};
+      while (SDL_PollEvent(&e)) {
+        switch (e.type) {
+        case SDL_QUIT:
+          return false;
+        }
       }
-    )";
 
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &vert_glsl, 0);
-    glCompileShader(vs);
-    glAttachShader(program, vs);
+      SDL_GetWindowSize(app->window, &app->width, &app->height);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    draw_frame(app, app->width, app->height);
+
+    if (capture) {
+      capture_frame(capture, app->width, app->height);
+    }
+
+    state_end_frame();
+
+    if (app->window) {
+      SDL_GL_SwapWindow(app->window);
+    } else {
+      present_headless(app);
+    }
 
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &frag_glsl, 0);
-    glCompileShader(fs);
-    glAttachShader(program, fs);
+    auto end = std::chrono::steady_clock::now();
+    frame_ms->push_back(
+        std::chrono::duration<double, std::milli>(end - begin).count());
 
-    glLinkProgram(program);
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    if (opts->frames > 0 && (int)(frame_ms->size() - first) >= opts->frames) {
+      return true;
+    }
   }
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Everything the render thread needs to draw one frame. input_time is when
+// the oldest input event folded into this packet was pumped, if there was one.
+struct FramePacket {
+  bool quit;
+  int width;
+  int height;
+  Clock::time_point built;
+  Clock::time_point input_time;
+  bool has_input;
+};
+
+// Bounded single-producer/single-consumer ring. Only the main thread writes
+// tail and only the render thread writes head, so both sides get by with
+// acquire/release atomics. The mutex is only there so the render thread can
+// sleep on nonempty instead of spinning while the ring is empty.
+struct PacketQueue {
+  std::vector<FramePacket> packets;
+  alignas(64) std::atomic<size_t> head;
+  alignas(64) std::atomic<size_t> tail;
+  std::mutex mutex;
+  std::condition_variable nonempty;
+};
+
+static bool push_packet(PacketQueue *q, const FramePacket &packet) {
+  size_t tail = q->tail.load(std::memory_order_relaxed);
+  if (tail - q->head.load(std::memory_order_acquire) == q->packets.size()) {
+    return false;
+  }
+
+  q->packets[tail % q->packets.size()] = packet;
+  q->tail.store(tail + 1, std::memory_order_release);
+
+  // taking the mutex orders this against a consumer that has just found the
+  // ring empty but not started waiting yet, so the wakeup can't get lost
+  { std::lock_guard<std::mutex> lock(q->mutex); }
+  q->nonempty.notify_one();
+  return true;
+}
+
+static bool pop_packet(PacketQueue *q, FramePacket *packet) {
+  size_t head = q->head.load(std::memory_order_relaxed);
+  if (head == q->tail.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  *packet = q->packets[head % q->packets.size()];
+  q->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+static void wait_packet(PacketQueue *q, FramePacket *packet) {
+  while (!pop_packet(q, packet)) {
+    std::unique_lock<std::mutex> lock(q->mutex);
+    q->nonempty.wait(lock, [q] {
+      return q->head.load(std::memory_order_relaxed) !=
+             q->tail.load(std::memory_order_acquire);
+    });
+  }
+}
+
+static void make_current(App *app, bool current) {
+  if (app->window) {
+    SDL_GL_MakeCurrent(app->window, current ? app->context : nullptr);
+    return;
+  }
+
+#if defined(HAS_EGL)
+  Headless *h = app->headless;
+  if (current) {
+    eglMakeCurrent(h->egl.display, h->egl.surface, h->egl.surface,
+                   h->egl.context);
+    glBindFramebuffer(GL_FRAMEBUFFER, h->fbo);
+  } else {
+    eglMakeCurrent(h->egl.display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   EGL_NO_CONTEXT);
+  }
+#endif
+}
+
+struct RenderThreadStats {
+  std::vector<double> frame_ms;
+  std::vector<double> packet_latency_ms;
+  std::vector<double> input_latency_ms;
+};
+
+static void render_thread(App *app, PacketQueue *queue,
+                          RenderThreadStats *stats) {
+  make_current(app, true);
+
+  Clock::time_point last_present = {};
+  for (;;) {
+    FramePacket packet = {};
+    wait_packet(queue, &packet);
+
+    if (packet.quit) {
+      break;
+    }
+
+    // only this thread touches app->width/height while it runs
+    app->width = packet.width;
+    app->height = packet.height;
+
+    draw_frame(app, app->width, app->height);
+    state_end_frame();
+
+    if (app->window) {
+      SDL_GL_SwapWindow(app->window);
+    } else {
+      present_headless(app);
+    }
+
+    auto presented = Clock::now();
+    if (last_present != Clock::time_point{}) {
+      stats->frame_ms.push_back(
+          std::chrono::duration<double, std::milli>(presented - last_present)
+              .count());
+    }
+    last_present = presented;
+
+    stats->packet_latency_ms.push_back(
+        std::chrono::duration<double, std::milli>(presented - packet.built)
+            .count());
+    if (packet.has_input) {
+      stats->input_latency_ms.push_back(
+          std::chrono::duration<double, std::milli>(presented -
+                                                    packet.input_time)
+              .count());
+    }
+  }
+
+  make_current(app, false);
+}
+
+static bool is_input_event(Uint32 type) {
+  switch (type) {
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+  case SDL_TEXTINPUT:
+  case SDL_MOUSEMOTION:
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+  case SDL_MOUSEWHEEL:
+  case SDL_CONTROLLERAXISMOTION:
+  case SDL_CONTROLLERBUTTONDOWN:
+  case SDL_CONTROLLERBUTTONUP:
+  case SDL_FINGERDOWN:
+  case SDL_FINGERUP:
+  case SDL_FINGERMOTION:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// The main thread side of --render-thread. When the queue is full, input keeps
+// being pumped and is folded into the next packet instead of blocking. Swapping
+// from a thread other than the one that created the window works with SDL on
+// Windows and X11, but not on macOS.
+static void run_render_thread(App *app) {
+  const Options *opts = app->opts;
+
+  PacketQueue queue;
+  queue.packets.resize(opts->queue_depth);
+  queue.head = 0;
+  queue.tail = 0;
+
+  RenderThreadStats stats;
+  if (opts->frames > 0) {
+    stats.frame_ms.reserve(opts->frames);
+    stats.packet_latency_ms.reserve(opts->frames);
+    stats.input_latency_ms.reserve(opts->frames);
+  }
+
+  make_current(app, false);
+  std::thread thread(render_thread, app, &queue, &stats);
+
+  FramePacket pending = {};
+  int width = app->width;
+  int height = app->height;
+  int frames = 0;
+  int full = 0;
 
   bool should_quit = false;
   while (!should_quit) {
-    SDL_Event e = {};
-    while (SDL_PollEvent(&e)) {
-      switch (e.type) {
-      case SDL_QUIT:
+    if (app->window) {
+      SDL_Event e = {};
+      while (SDL_PollEvent(&e)) {
+        if (e.type == SDL_QUIT) {
+          should_quit = true;
+        } else if (is_input_event(e.type) && !pending.has_input) {
+          pending.has_input = true;
+          pending.input_time = Clock::now();
+        }
+      }
+
+      SDL_GetWindowSize(app->window, &width, &height);
+    }
+
+    pending.width = width;
+    pending.height = height;
+    pending.built = Clock::now();
+
+    if (push_packet(&queue, pending)) {
+      pending = {};
+      frames++;
+      if (opts->frames > 0 && frames >= opts->frames) {
         should_quit = true;
-        break;
       }
+    } else {
+      full++;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
+  }
 
-    int width = 0;
-    int height = 0;
-    SDL_GetWindowSize(window, &width, &height);
-    glViewport(0, 0, width, height);
+  FramePacket quit = {};
+  quit.quit = true;
+  while (!push_packet(&queue, quit)) {
+    std::this_thread::yield();
+  }
 
-    glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+  thread.join();
+  make_current(app, true);
 
-    glUseProgram(program);
-    glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+  printf("render thread, queue depth %d, producer found it full %d times\n",
+         opts->queue_depth, full);
+  if (stats.frame_ms.empty()) {
+    return;
+  }
+
+  double mean = 0;
+  for (double ms : stats.frame_ms) {
+    mean += ms;
+  }
+  mean /= stats.frame_ms.size();
+
+  double variance = 0;
+  for (double ms : stats.frame_ms) {
+    variance += (ms - mean) * (ms - mean);
+  }
+  variance /= stats.frame_ms.size();
+
+  // print_frame_stats leaves frame_ms sorted
+  print_frame_stats(&stats.frame_ms, triangles_per_frame(app));
+  printf("frame jitter: stddev %.3f ms, p99 - p50 %.3f ms\n", sqrt(variance),
+         stats.frame_ms[(size_t)(0.99 * (stats.frame_ms.size() - 1) + 0.5)] -
+             stats.frame_ms[(size_t)(0.50 * (stats.frame_ms.size() - 1) + 0.5)]);
+  print_percentiles("packet to present", &stats.packet_latency_ms);
+  if (!stats.input_latency_ms.empty()) {
+    print_percentiles("input to present", &stats.input_latency_ms);
+  }
+}
+
+int main(int argc, char **argv) {
+  Options opts = {};
+  if (!parse_options(argc, argv, &opts)) {
+    fprintf(stderr,
+            "usage: %s [--headless] [--frames N] [--draws N] [--size WxH] "
+            "[--dump out.ppm] [--capture out.ppm] [--capture-buffers N] "
+            "[--no-state-cache] [--verify-state] [--render-thread] "
+            "[--queue-depth N] [--compute N] [--sync-timing]\n",
+            argv[0]);
+    return 1;
+  }
+
+  SDL_Window *window = nullptr;
+  SDL_GLContext context = nullptr;
+#if defined(HAS_EGL)
+  Headless headless = {};
+#endif
+
+  int gl_major = opts.compute ? 4 : 3;
+  int gl_minor = 3;
+  GLADloadfunc load = nullptr;
+
+  if (opts.headless) {
+#if defined(HAS_EGL)
+    if (!create_headless(&headless, gl_major, gl_minor, opts.width,
+                         opts.height)) {
+      return 1;
+    }
+    load = (GLADloadfunc)eglGetProcAddress;
+#else
+    fprintf(stderr, "--headless needs EGL, which is only wired up on Linux\n");
+    return 1;
+#endif
+  } else {
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, gl_major);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, gl_minor);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
+                        SDL_GL_CONTEXT_PROFILE_CORE);
+
+    window = SDL_CreateWindow("SDL2 + OpenGL", SDL_WINDOWPOS_CENTERED,
+                              SDL_WINDOWPOS_CENTERED, opts.width, opts.height,
+                              SDL_WINDOW_RESIZABLE | SDL_WINDOW_OPENGL);
+
+    context = SDL_GL_CreateContext(window);
+    load = (GLADloadfunc)SDL_GL_GetProcAddress;
+    gladLoadGL(load);
+  }
+
+  if (opts.compute && !load_gl43(load)) {
+    fprintf(stderr, "--compute needs glDispatchCompute and glMemoryBarrier\n");
+    return 1;
+  }
+
+  state_init(opts.state_cache, opts.verify_state);
+
+  App app = {};
+  app.opts = &opts;
+  app.window = window;
+  app.context = context;
+#if defined(HAS_EGL)
+  app.headless = &headless;
+#endif
+  app.vao = create_triangle_vao();
+  app.program = create_triangle_program();
+
+  Particles particles = {};
+  if (opts.compute) {
+    create_particles(&particles, opts.compute, opts.sync_timing);
+    app.particles = &particles;
+  }
+  app.width = opts.width;
+  app.height = opts.height;
+
+  std::vector<double> frame_ms;
+  if (opts.frames > 0) {
+    frame_ms.reserve(opts.frames);
+  }
+
+  if (opts.render_thread) {
+    run_render_thread(&app);
+  } else if (opts.capture) {
+    bool quit = false;
+    if (opts.frames > 0) {
+      printf("baseline, no capture:\n");
+      quit = !run_frames(&app, nullptr, &frame_ms);
+      print_frame_stats(&frame_ms, triangles_per_frame(&app));
+      frame_ms.clear();
+    }
+
+    Capture capture;
+    if (!quit && start_capture(&capture, opts.capture, opts.capture_buffers)) {
+      auto begin = std::chrono::steady_clock::now();
+      run_frames(&app, &capture, &frame_ms);
+      finish_capture(&capture);
+      auto end = std::chrono::steady_clock::now();
+
+      double seconds = std::chrono::duration<double>(end - begin).count();
+      printf("capture, %d pixel pack buffers:\n", opts.capture_buffers);
+      print_frame_stats(&frame_ms, triangles_per_frame(&app));
+      printf("%d frames written to %s, %.1f capture fps, "
+             "%d fence stalls, %d writer stalls\n",
+             capture.frames_written, opts.capture,
+             capture.frames_written / seconds, capture.fence_stalls,
+             capture.writer_stalls);
+    } else if (!quit) {
+      fprintf(stderr, "could not open %s\n", opts.capture);
+    }
+  } else {
+    run_frames(&app, nullptr, &frame_ms);
+    print_frame_stats(&frame_ms, triangles_per_frame(&app));
+  }
+
+  if (app.particles) {
+    print_particle_stats(app.particles);
+  }
+  print_state_stats();
+
+  if (opts.dump) {
+    // the last frame was already swapped, and the front buffer's contents are
+    // undefined after a swap, so draw one more and read it before swapping
+    draw_frame(&app, app.width, app.height);
+    state_end_frame();
+    if (window) {
+      glReadBuffer(GL_BACK);
+    }
+
+    if (!dump_framebuffer(opts.dump, app.width, app.height)) {
+      fprintf(stderr, "could not write %s\n", opts.dump);
+    }
+  }
+
+  if (app.present_fence) {
+    glDeleteSync(app.present_fence);
+  }
 
-    SDL_GL_SwapWindow(window);
+#if defined(HAS_EGL)
+  if (opts.headless) {
+    destroy_headless(&headless);
   }
+#endif
 }
@@ -1,12 +1,579 @@
 // cl /std:c++17 /nologo /Zi /Iinclude sdl2-webgpu.cpp lib/sdl2.lib lib/sdl2main.lib lib/webgpu.lib
+//
+// sdl2-webgpu [--frames N] [--pipelines N] [--static N] [--invalidate N]
+//             [--stream MB]
+//
+// The pipeline compiles asynchronously while cleared frames are presented.
+//
+// --pipelines N     N more pipelines compiled asynchronously, each drawn once
+//                   ready
+// --static N        N static draws, render bundle vs re-encoding by turns
+// --invalidate N    replace the static buffer or pipeline every N frames
+// --stream MB       MB per frame in 1 MB writes, staging belt vs
+//                   wgpuQueueWriteBuffer by turns, throughput and CPU bytes
+//                   written per byte streamed
+// --frames N        close after N frames
 
 #define SDL_MAIN_HANDLED
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
 #include <webgpu.h>
+#include <bench.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Options {
+  int frames = 0; // 0 runs until the window is closed
+  int pipelines = 0;
+  int static_draws = 0;
+  int invalidate = 0;
+  int stream_mb = 0;
+};
+
+static bool parse_options(int argc, char **argv, Options *opts) {
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (strcmp(arg, "--frames") == 0 && next) {
+      opts->frames = atoi(next);
+      i++;
+    } else if (strcmp(arg, "--pipelines") == 0 && next) {
+      opts->pipelines = std::max(atoi(next), 0);
+      i++;
+    } else if (strcmp(arg, "--static") == 0 && next) {
+      opts->static_draws = std::max(atoi(next), 0);
+      i++;
+    } else if (strcmp(arg, "--invalidate") == 0 && next) {
+      opts->invalidate = std::max(atoi(next), 0);
+      i++;
+    } else if (strcmp(arg, "--stream") == 0 && next) {
+      opts->stream_mb = std::max(atoi(next), 0);
+      i++;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static double ms_since(std::chrono::steady_clock::time_point begin) {
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Dawn may run request callbacks inside the request or only from a later
+// wgpuInstanceProcessEvents, so nothing is used before done is set
+static void wait_for(WGPUInstance instance, const bool *done) {
+  for (;;) {
+    wgpuInstanceProcessEvents(instance);
+    if (*done) {
+      return;
+    }
+    SDL_Delay(1);
+  }
+}
+
+struct Vertex {
+  float position[3];
+  float color[4];
+};
+
+static WGPUBuffer create_vertex_buffer(WGPUDevice device, WGPUQueue queue,
+                                       const Vertex *vertices, size_t count) {
+  WGPUBufferDescriptor desc = {};
+  desc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
+  desc.size = count * sizeof(Vertex);
+
+  WGPUBuffer buffer = wgpuDeviceCreateBuffer(device, &desc);
+  wgpuQueueWriteBuffer(queue, buffer, 0, vertices, desc.size);
+  return buffer;
+}
+
+// fragment_color is the WGSL expression fs_main returns, so pipelines can be
+// given shaders that differ and have to be compiled separately
+static WGPUShaderModule create_shaders(WGPUDevice device,
+                                       const char *fragment_color = "in.color") {
+  std::string code = R"(
+    struct VertexIn {
+      @location(0) position: vec3f,
+      @location(1) color: vec4f,
+    }
+
+    struct VertexOut {
+      @builtin(position) position: vec4f,
+      @location(1) color: vec4f,
+    }
+
+    @vertex
+    fn vs_main(in: VertexIn) -> VertexOut {
+      var out: VertexOut;
+      out.position = vec4f(in.position, 1.0f);
+      out.color = in.color;
+      return out;
+    }
+
+    @fragment
+    fn fs_main(in: VertexOut) -> @location(0) vec4f {
+      return )";
+  code += fragment_color;
+  code += R"(;
+    }
+  )";
+
+  WGPUShaderModuleWGSLDescriptor wgsl = {};
+  wgsl.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
+  wgsl.code = code.c_str();
+
+  WGPUShaderModuleDescriptor desc = {};
+  desc.nextInChain = &wgsl.chain;
+  return wgpuDeviceCreateShaderModule(device, &desc);
+}
+
+// Fills in the pipeline descriptor for shaders and passes it to create, which
+// is called before the structs the descriptor points to go out of scope
+template <typename Create>
+static void describe_pipeline(WGPUShaderModule shaders, Create create) {
+  WGPUVertexAttribute attrs[] = {
+      {WGPUVertexFormat_Float32x3, offsetof(Vertex, position), 0},
+      {WGPUVertexFormat_Float32x4, offsetof(Vertex, color), 1},
+  };
+
+  WGPUVertexBufferLayout vs_layout = {};
+  vs_layout.arrayStride = sizeof(Vertex);
+  vs_layout.stepMode = WGPUVertexStepMode_Vertex;
+  vs_layout.attributeCount = 2;
+  vs_layout.attributes = attrs;
+
+  WGPUVertexState vs = {};
+  vs.module = shaders;
+  vs.entryPoint = "vs_main";
+  vs.bufferCount = 1;
+  vs.buffers = &vs_layout;
+
+  WGPUColorTargetState fs_target = {};
+  fs_target.format = WGPUTextureFormat_BGRA8Unorm;
+  fs_target.writeMask = WGPUColorWriteMask_All;
+
+  WGPUFragmentState fs = {};
+  fs.module = shaders;
+  fs.entryPoint = "fs_main";
+  fs.targetCount = 1;
+  fs.targets = &fs_target;
+
+  WGPURenderPipelineDescriptor desc = {};
+  desc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+  desc.primitive.frontFace = WGPUFrontFace_CCW;
+  desc.primitive.cullMode = WGPUCullMode_None;
+  desc.vertex = vs;
+  desc.fragment = &fs;
+  desc.multisample.count = 1;
+  desc.multisample.mask = 0xffffffff;
+  desc.multisample.alphaToCoverageEnabled = false;
+
+  create(&desc);
+}
+
+static WGPURenderPipeline create_pipeline(WGPUDevice device,
+                                          WGPUShaderModule shaders) {
+  WGPURenderPipeline pipeline = nullptr;
+  describe_pipeline(shaders, [&](const WGPURenderPipelineDescriptor *desc) {
+    pipeline = wgpuDeviceCreateRenderPipeline(device, desc);
+  });
+  return pipeline;
+}
+
+// A pipeline being compiled by wgpuDeviceCreateRenderPipelineAsync. Until done
+// is set by the callback, which happens in wgpuDeviceTick, it is not drawn.
+struct PendingPipeline {
+  WGPURenderPipeline pipeline = nullptr; // stays null if compiling failed
+  bool done = false;
+  double ready_ms = 0; // since start
+  std::chrono::steady_clock::time_point start;
+};
+
+static void create_pipeline_async(WGPUDevice device, WGPUShaderModule shaders,
+                                  std::chrono::steady_clock::time_point start,
+                                  PendingPipeline *pending) {
+  pending->start = start;
+  describe_pipeline(shaders, [&](const WGPURenderPipelineDescriptor *desc) {
+    wgpuDeviceCreateRenderPipelineAsync(
+        device, desc,
+        [](WGPUCreatePipelineAsyncStatus status, WGPURenderPipeline pipeline,
+           const char *msg, void *udata) {
+          PendingPipeline *dst = (PendingPipeline *)udata;
+          if (status != WGPUCreatePipelineAsyncStatus_Success) {
+            fprintf(stderr, "pipeline failed: %s\n", msg ? msg : "");
+          }
+          dst->pipeline = pipeline;
+          dst->done = true;
+          dst->ready_ms = ms_since(dst->start);
+        },
+        pending);
+  });
+}
+
+// The calls static draws are made of, for a render pass and for a render
+// bundle encoder, so encode_static_draws is written once for both
+static void set_pipeline(WGPURenderPassEncoder pass,
+                         WGPURenderPipeline pipeline) {
+  wgpuRenderPassEncoderSetPipeline(pass, pipeline);
+}
+
+static void set_pipeline(WGPURenderBundleEncoder bundle,
+                         WGPURenderPipeline pipeline) {
+  wgpuRenderBundleEncoderSetPipeline(bundle, pipeline);
+}
+
+static void set_vertex_buffer(WGPURenderPassEncoder pass, WGPUBuffer buffer,
+                              uint64_t offset, uint64_t size) {
+  wgpuRenderPassEncoderSetVertexBuffer(pass, 0, buffer, offset, size);
+}
+
+static void set_vertex_buffer(WGPURenderBundleEncoder bundle,
+                              WGPUBuffer buffer, uint64_t offset,
+                              uint64_t size) {
+  wgpuRenderBundleEncoderSetVertexBuffer(bundle, 0, buffer, offset, size);
+}
+
+static void draw(WGPURenderPassEncoder pass, uint32_t vertices) {
+  wgpuRenderPassEncoderDraw(pass, vertices, 1, 0, 0);
+}
+
+static void draw(WGPURenderBundleEncoder bundle, uint32_t vertices) {
+  wgpuRenderBundleEncoderDraw(bundle, vertices, 1, 0, 0);
+}
+
+// Triangles that never move, one draw each. Every replacement of the
+// pipeline or vertex buffer bumps generation, which is what bundles
+// recorded from the scene are checked against.
+struct StaticScene {
+  int count = 0;
+  WGPUBuffer vbuf = nullptr;
+  WGPURenderPipeline pipeline = nullptr;
+  int generation = 0;
+};
+
+// Small triangles on a grid over the whole window. variant shifts them by a
+// fraction of a cell, so a replaced buffer visibly differs from the last.
+static std::vector<Vertex> static_vertices(int count, int variant) {
+  std::vector<Vertex> vertices(count * 3);
+  int columns = (int)ceilf(sqrtf((float)count));
+  float cell = 2.0f / columns;
+  float shift = (variant % 4) * cell * 0.1f;
+
+  for (int i = 0; i < count; i++) {
+    float x = -1.0f + (i % columns + 0.2f) * cell + shift;
+    float y = -1.0f + (i / columns + 0.2f) * cell;
+    float r = (float)(i * 37 % 256) / 255.0f;
+    float g = (float)(i * 91 % 256) / 255.0f;
+    float b = (float)(i * 13 % 256) / 255.0f;
+
+    Vertex *v = &vertices[i * 3];
+    v[0] = {{x + cell * 0.3f, y + cell * 0.6f, 0.0f}, {r, g, b, 1.0f}};
+    v[1] = {{x, y, 0.0f}, {r, g, b, 1.0f}};
+    v[2] = {{x + cell * 0.6f, y, 0.0f}, {r, g, b, 1.0f}};
+  }
+  return vertices;
+}
+
+static void replace_static_buffer(WGPUDevice device, WGPUQueue queue,
+                                  StaticScene *scene, int variant) {
+  if (scene->vbuf) {
+    wgpuBufferRelease(scene->vbuf);
+  }
+
+  std::vector<Vertex> vertices = static_vertices(scene->count, variant);
+  scene->vbuf =
+      create_vertex_buffer(device, queue, vertices.data(), vertices.size());
+  scene->generation++;
+}
+
+static void replace_static_pipeline(WGPUDevice device,
+                                    WGPUShaderModule shaders,
+                                    StaticScene *scene) {
+  if (scene->pipeline) {
+    wgpuRenderPipelineRelease(scene->pipeline);
+  }
+
+  scene->pipeline = create_pipeline(device, shaders);
+  scene->generation++;
+}
+
+template <typename Encoder>
+static void encode_static_draws(Encoder encoder, const StaticScene &scene) {
+  uint64_t size = 3 * sizeof(Vertex);
+  for (int i = 0; i < scene.count; i++) {
+    set_pipeline(encoder, scene.pipeline);
+    set_vertex_buffer(encoder, scene.vbuf, i * size, size);
+    draw(encoder, 3);
+  }
+}
+
+struct StaticBundle {
+  WGPURenderBundle bundle = nullptr;
+  int generation = 0; // of the scene the bundle was recorded from
+  int recordings = 0;
+  double record_ms = 0;
+};
+
+// Returns the bundle for scene, recording it again first if the pipeline or
+// vertex buffer it was recorded with have been replaced since
+static WGPURenderBundle update_bundle(WGPUDevice device, StaticBundle *b,
+                                      const StaticScene &scene) {
+  if (b->bundle && b->generation == scene.generation) {
+    return b->bundle;
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  if (b->bundle) {
+    wgpuRenderBundleRelease(b->bundle);
+  }
+
+  WGPUTextureFormat format = WGPUTextureFormat_BGRA8Unorm;
+  WGPURenderBundleEncoderDescriptor desc = {};
+  desc.colorFormatsCount = 1;
+  desc.colorFormats = &format;
+  desc.depthStencilFormat = WGPUTextureFormat_Undefined;
+  desc.sampleCount = 1;
+
+  WGPURenderBundleEncoder encoder =
+      wgpuDeviceCreateRenderBundleEncoder(device, &desc);
+  encode_static_draws(encoder, scene);
+  b->bundle = wgpuRenderBundleEncoderFinish(encoder, nullptr);
+  wgpuRenderBundleEncoderRelease(encoder);
+
+  b->generation = scene.generation;
+  b->recordings++;
+  b->record_ms += ms_since(begin);
+  return b->bundle;
+}
+
+static void print_static_stats(const StaticScene &scene, const StaticBundle &b,
+                               std::vector<double> *bundle_ms,
+                               std::vector<double> *encode_ms) {
+  if (bundle_ms->empty() || encode_ms->empty()) {
+    return;
+  }
+
+  printf("static: %d draws, bundle recorded %d times, %.3f ms each\n",
+         scene.count, b.recordings, b.record_ms / std::max(b.recordings, 1));
+  double bundle = print_percentiles("  execute bundle", bundle_ms);
+  double encode = print_percentiles("  re-encode     ", encode_ms);
+  printf("  %.2fx less CPU time per frame with the bundle\n",
+         (encode / encode_ms->size()) / (bundle / bundle_ms->size()));
+}
+
+// A buffer of the staging belt. It is either mapped, and writes are placed
+// after used, or unmapped while the GPU copies out of it and until the
+// MapAsync requested after the submit has completed.
+struct StagingChunk {
+  WGPUBuffer buffer = nullptr;
+  uint64_t size = 0;
+  uint64_t used = 0;
+  uint8_t *mapped = nullptr;
+  bool mapping = false;
+};
+
+struct StagingBelt {
+  WGPUDevice device = nullptr;
+  uint64_t chunk_size = 0;
+  uint64_t max_pool_bytes = 0;
+  std::vector<StagingChunk *> chunks;
+  uint64_t pool_bytes = 0;
+  int waits = 0; // writes that had to wait for a chunk to be mapped
+};
+
+static StagingChunk *create_staging_chunk(StagingBelt *belt, uint64_t size) {
+  StagingChunk *chunk = new StagingChunk();
+  chunk->size = std::max(size, belt->chunk_size);
+
+  WGPUBufferDescriptor desc = {};
+  desc.usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc;
+  desc.size = chunk->size;
+  desc.mappedAtCreation = true;
+  chunk->buffer = wgpuDeviceCreateBuffer(belt->device, &desc);
+  chunk->mapped =
+      (uint8_t *)wgpuBufferGetMappedRange(chunk->buffer, 0, chunk->size);
+
+  belt->chunks.push_back(chunk);
+  belt->pool_bytes += chunk->size;
+  return chunk;
+}
+
+// Returns size bytes of mapped memory to write what should end up at offset
+// in target, and records the copy there in encoder. size and offset must be
+// multiples of 4. What is returned may only be written until belt_finish.
+// Once the pool is at max_pool_bytes, this ticks the device until a chunk
+// comes back instead of creating another one, unless none is being mapped.
+static void *belt_write(StagingBelt *belt, WGPUCommandEncoder encoder,
+                        WGPUBuffer target, uint64_t offset, uint64_t size) {
+  StagingChunk *chunk = nullptr;
+  bool waited = false;
+  while (chunk == nullptr) {
+    bool mapping = false;
+    for (StagingChunk *c : belt->chunks) {
+      if (c->mapped && c->size - c->used >= size) {
+        chunk = c;
+        break;
+      }
+      mapping |= c->mapping;
+    }
+    if (chunk != nullptr) {
+      break;
+    }
+
+    uint64_t grow = std::max(size, belt->chunk_size);
+    if (!mapping || belt->pool_bytes + grow <= belt->max_pool_bytes) {
+      chunk = create_staging_chunk(belt, size);
+    } else {
+      wgpuDeviceTick(belt->device);
+      waited = true;
+    }
+  }
+  belt->waits += waited;
+
+  wgpuCommandEncoderCopyBufferToBuffer(encoder, chunk->buffer, chunk->used,
+                                       target, offset, size);
+  void *dst = chunk->mapped + chunk->used;
+  chunk->used += size;
+  return dst;
+}
+
+// Unmaps the chunks written to since the last call. Must be called before the
+// command buffer with their copies is submitted.
+static void belt_finish(StagingBelt *belt) {
+  for (StagingChunk *c : belt->chunks) {
+    if (c->mapped && c->used > 0) {
+      wgpuBufferUnmap(c->buffer);
+      c->mapped = nullptr;
+    }
+  }
+}
+
+// Maps unmapped chunks again once the GPU is done with them. The callbacks run
+// in a later wgpuDeviceTick, so until then writes go to other chunks.
+static void belt_recall(StagingBelt *belt) {
+  for (StagingChunk *c : belt->chunks) {
+    if (c->mapped || c->mapping) {
+      continue;
+    }
+
+    c->mapping = true;
+    wgpuBufferMapAsync(
+        c->buffer, WGPUMapMode_Write, 0, c->size,
+        [](WGPUBufferMapAsyncStatus status, void *udata) {
+          StagingChunk *c = (StagingChunk *)udata;
+          c->mapping = false;
+          if (status == WGPUBufferMapAsyncStatus_Success) {
+            c->mapped = (uint8_t *)wgpuBufferGetMappedRange(c->buffer, 0,
+                                                            c->size);
+            c->used = 0;
+          }
+        },
+        c);
+  }
+}
+
+static const uint64_t STREAM_WRITE = 1 << 20;
+
+// Bytes the CPU wrote on each path, per byte that reached the GPU buffer
+struct StreamStats {
+  std::vector<double> ms;
+  uint64_t streamed = 0;
+  uint64_t generated = 0;
+  uint64_t queue_copied = 0;
+};
+
+// What is streamed, generated in place so the belt path writes it straight
+// into mapped memory
+static void fill_stream(uint32_t *dst, uint64_t bytes, uint32_t seed,
+                        StreamStats *stats) {
+  for (uint64_t i = 0; i < bytes / 4; i++) {
+    dst[i] = seed ^ (uint32_t)i;
+  }
+  stats->generated += bytes;
+}
+
+// wgpuQueueWriteBuffer has copied data by the time it returns, since the
+// caller may reuse it right away, so all of it counts as a CPU copy
+static void stream_write_buffer(WGPUQueue queue, WGPUBuffer buffer,
+                                uint64_t offset, const void *data,
+                                uint64_t size, StreamStats *stats) {
+  wgpuQueueWriteBuffer(queue, buffer, offset, data, size);
+  stats->queue_copied += size;
+}
+
+static void print_stream_stats(int stream_mb, const StagingBelt &belt,
+                               StreamStats *staged, StreamStats *written) {
+  if (staged->ms.empty() || written->ms.empty()) {
+    return;
+  }
+
+  printf("stream: %d MB per frame, staging pool %zu buffers, %.0f MB of %.0f "
+         "MB, %d writes waited for a buffer\n",
+         stream_mb, belt.chunks.size(), belt.pool_bytes / (1024.0 * 1024.0),
+         belt.max_pool_bytes / (1024.0 * 1024.0), belt.waits);
+
+  StreamStats *paths[] = {staged, written};
+  const char *labels[] = {"  staging belt", "  write buffer"};
+  for (int i = 0; i < 2; i++) {
+    const StreamStats *p = paths[i];
+    double total = print_percentiles(labels[i], &paths[i]->ms);
+    printf("  %.0f MB/s, CPU wrote %.2f bytes per byte streamed (%.2f "
+           "generated, %.2f copied by the queue)\n",
+           stream_mb * p->ms.size() / (total / 1000.0),
+           (double)(p->generated + p->queue_copied) / p->streamed,
+           (double)p->generated / p->streamed,
+           (double)p->queue_copied / p->streamed);
+  }
+}
+
+static void print_startup_stats(double adapter_ms, double device_ms,
+                                double first_frame_ms,
+                                const PendingPipeline &main_pipeline,
+                                const std::vector<PendingPipeline> &batch,
+                                int frames_while_compiling) {
+  printf("startup: adapter %.1f ms, device %.1f ms, first frame %.1f ms\n",
+         adapter_ms, device_ms, first_frame_ms);
+
+  int ready = main_pipeline.done;
+  double all_ready_ms = main_pipeline.ready_ms;
+  for (const PendingPipeline &p : batch) {
+    ready += p.done;
+    all_ready_ms = std::max(all_ready_ms, p.ready_ms);
+  }
+
+  int total = 1 + (int)batch.size();
+  if (ready < total) {
+    printf("pipelines: %d of %d ready at exit\n", ready, total);
+  } else {
+    printf("pipelines: all %d ready after %.1f ms, %d frames shown while "
+           "compiling\n",
+           total, all_ready_ms, frames_while_compiling);
+  }
+}
+
+int main(int argc, char **argv) {
+  Options opts = {};
+  if (!parse_options(argc, argv, &opts)) {
+    fprintf(stderr,
+            "usage: %s [--frames N] [--pipelines N] [--static N] "
+            "[--invalidate N] [--stream MB]\n",
+            argv[0]);
+    return 1;
+  }
+
+  auto startup = std::chrono::steady_clock::now();
 
-int main() {
   SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
 
   int width = 800, height = 600;
@@ -31,38 +598,65 @@ int main() {
 
   WGPUAdapter adapter = nullptr;
   {
+    struct Request {
+      WGPUAdapter adapter = nullptr;
+      bool done = false;
+    } request;
+
     WGPURequestAdapterOptions options = {};
     options.compatibleSurface = surface;
     wgpuInstanceRequestAdapter(
         instance, &options,
         [](WGPURequestAdapterStatus status, WGPUAdapter adapter,
            const char *msg, void *udata) {
-          WGPUAdapter *dst = (WGPUAdapter *)udata;
-          *dst = adapter;
+          Request *dst = (Request *)udata;
+          if (status != WGPURequestAdapterStatus_Success) {
+            fprintf(stderr, "no adapter: %s\n", msg ? msg : "");
+          }
+          dst->adapter = adapter;
+          dst->done = true;
         },
-        &adapter);
+        &request);
+
+    wait_for(instance, &request.done);
+    adapter = request.adapter;
+  }
+  if (adapter == nullptr) {
+    return 1;
   }
+  double adapter_ms = ms_since(startup);
 
   WGPUDevice device = nullptr;
   {
+    struct Request {
+      WGPUDevice device = nullptr;
+      bool done = false;
+    } request;
+
     WGPUDeviceDescriptor desc = {};
     wgpuAdapterRequestDevice(
         adapter, &desc,
         [](WGPURequestDeviceStatus status, WGPUDevice device, char const *msg,
            void *udata) {
-          WGPUDevice *dst = (WGPUDevice *)udata;
-          *dst = device;
+          Request *dst = (Request *)udata;
+          if (status != WGPURequestDeviceStatus_Success) {
+            fprintf(stderr, "no device: %s\n", msg ? msg : "");
+          }
+          dst->device = device;
+          dst->done = true;
         },
-        &device);
+        &request);
+
+    wait_for(instance, &request.done);
+    device = request.device;
+  }
+  if (device == nullptr) {
+    return 1;
   }
+  double device_ms = ms_since(startup);
 
   WGPUQueue queue = wgpuDeviceGetQueue(device);
 
-  struct Vertex {
-    float position[3];
-    float color[4];
-  };
-
   WGPUBuffer vbuf = nullptr;
   {
     Vertex vertices[] = {
@@ -70,96 +664,66 @@ int main() {
         {{-0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}},
         {{+0.5f, -0.5f, 0.0f}, {0.0f, 0.0f, 1.0f, 1.0f}},
     };
-
-    WGPUBufferDescriptor desc = {};
-
-    desc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
-    desc.size = sizeof(vertices);
-    vbuf = wgpuDeviceCreateBuffer(device, &desc);
-    wgpuQueueWriteBuffer(queue, vbuf, 0, vertices, sizeof(vertices));
+    vbuf = create_vertex_buffer(device, queue, vertices, 3);
   }
 
-  WGPUShaderModule shaders = nullptr;
-  {
-    WGPUShaderModuleWGSLDescriptor wgsl = {};
-    wgsl.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
-    wgsl.code = R"(
-      struct VertexIn {
-        @location(0) position: vec3f,
-        @location(1) color: vec4f,
-      }
-
-      struct VertexOut {
-        @builtin(position) position: vec4f,
-        @location(1) color: vec4f,
-      }
+  WGPUShaderModule shaders = create_shaders(device);
+  PendingPipeline pipeline;
+  create_pipeline_async(device, shaders, startup, &pipeline);
+
+  // a small triangle per pipeline, tinted differently so no two share a shader
+  std::vector<PendingPipeline> batch(opts.pipelines);
+  WGPUBuffer batch_vbuf = nullptr;
+  if (opts.pipelines > 0) {
+    std::vector<Vertex> vertices = static_vertices(opts.pipelines, 2);
+    batch_vbuf =
+        create_vertex_buffer(device, queue, vertices.data(), vertices.size());
+
+    for (int i = 0; i < opts.pipelines; i++) {
+      char color[64];
+      snprintf(color, sizeof(color), "vec4f(in.color.rgb * %.4f, 1.0f)",
+               0.25f + 0.75f * i / opts.pipelines);
+      WGPUShaderModule module = create_shaders(device, color);
+      create_pipeline_async(device, module, startup, &batch[i]);
+      wgpuShaderModuleRelease(module);
+    }
+  }
 
-      @vertex
-      fn vs_main(in: VertexIn) -> VertexOut {
-        var out: VertexOut;
-        out.position = vec4f(in.position, 1.0f);
-        out.color = in.color;
-        return out;
-      }
+  double first_frame_ms = 0;
+  int frames_while_compiling = 0;
 
-      @fragment
-      fn fs_main(in: VertexOut) -> @location(0) vec4f {
-        return in.color;
-      }
-    )";
+  WGPUBuffer stream_buffer = nullptr;
+  uint64_t stream_bytes = (uint64_t)opts.stream_mb << 20;
+  std::vector<uint8_t> stream_data;
+  StagingBelt belt;
+  StreamStats staged, written;
+  if (stream_bytes > 0) {
+    WGPUBufferDescriptor desc = {};
+    desc.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst;
+    desc.size = stream_bytes;
+    stream_buffer = wgpuDeviceCreateBuffer(device, &desc);
 
-    WGPUShaderModuleDescriptor desc = {};
-    desc.nextInChain = &wgsl.chain;
-    shaders = wgpuDeviceCreateShaderModule(device, &desc);
+    stream_data.resize(STREAM_WRITE);
+    belt.device = device;
+    belt.chunk_size = 16 * STREAM_WRITE;
+    belt.max_pool_bytes = 2 * std::max(stream_bytes, belt.chunk_size);
   }
 
-  WGPURenderPipeline pipeline = nullptr;
-  {
-    WGPUVertexAttribute attrs[] = {
-        {WGPUVertexFormat_Float32x3, offsetof(Vertex, position), 0},
-        {WGPUVertexFormat_Float32x4, offsetof(Vertex, color), 1},
-    };
-
-    WGPUVertexBufferLayout vs_layout = {};
-    vs_layout.arrayStride = sizeof(Vertex);
-    vs_layout.stepMode = WGPUVertexStepMode_Vertex;
-    vs_layout.attributeCount = 2;
-    vs_layout.attributes = attrs;
-
-    WGPUVertexState vs = {};
-    vs.module = shaders;
-    vs.entryPoint = "vs_main";
-    vs.bufferCount = 1;
-    vs.buffers = &vs_layout;
-
-    WGPUColorTargetState fs_target = {};
-    fs_target.format = WGPUTextureFormat_BGRA8Unorm;
-    fs_target.writeMask = WGPUColorWriteMask_All;
-
-    WGPUFragmentState fs = {};
-    fs.module = shaders;
-    fs.entryPoint = "fs_main";
-    fs.targetCount = 1;
-    fs.targets = &fs_target;
-
-    WGPURenderPipelineDescriptor desc = {};
-    desc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
-    desc.primitive.frontFace = WGPUFrontFace_CCW;
-    desc.primitive.cullMode = WGPUCullMode_None;
-    desc.vertex = vs;
-    desc.fragment = &fs;
-    desc.multisample.count = 1;
-    desc.multisample.mask = 0xffffffff;
-    desc.multisample.alphaToCoverageEnabled = false;
-
-    pipeline = wgpuDeviceCreateRenderPipeline(device, &desc);
+  StaticScene scene;
+  StaticBundle bundle;
+  std::vector<double> bundle_ms, encode_ms;
+  if (opts.static_draws > 0) {
+    scene.count = opts.static_draws;
+    replace_static_buffer(device, queue, &scene, 0);
+    replace_static_pipeline(device, shaders, &scene);
   }
 
   WGPUSwapChain swapchain = nullptr;
   int swapchain_width = 0, swapchain_height = 0;
 
+  int frame = 0;
   bool should_quit = false;
-  while (!should_quit) {
+  while (!should_quit && (opts.frames == 0 || frame < opts.frames)) {
     SDL_Event e = {};
     while (SDL_PollEvent(&e)) {
       switch (e.type) {
@@ -196,9 +760,48 @@ int main() {
       continue;
     }
 
+    // even frames replay the bundle, odd ones encode every draw, so both
+    // run under the same conditions
+    bool use_bundle = frame % 2 == 0;
+    if (scene.count > 0) {
+      if (opts.invalidate > 0 && frame > 0 && frame % opts.invalidate == 0) {
+        if (frame / opts.invalidate % 2) {
+          replace_static_buffer(device, queue, &scene, frame / opts.invalidate);
+        } else {
+          replace_static_pipeline(device, shaders, &scene);
+        }
+      }
+      if (use_bundle) {
+        update_bundle(device, &bundle, scene);
+      }
+    }
+
     WGPUCommandEncoder encoder =
         wgpuDeviceCreateCommandEncoder(device, nullptr);
 
+    // even frames stream through the belt, odd ones through WriteBuffer; the
+    // time covers generating the data, the copies and submitting them
+    auto stream_begin = std::chrono::steady_clock::now();
+    bool use_belt = frame % 2 == 0;
+    for (uint64_t offset = 0; offset < stream_bytes; offset += STREAM_WRITE) {
+      if (use_belt) {
+        void *dst =
+            belt_write(&belt, encoder, stream_buffer, offset, STREAM_WRITE);
+        fill_stream((uint32_t *)dst, STREAM_WRITE, frame, &staged);
+        staged.streamed += STREAM_WRITE;
+      } else {
+        fill_stream((uint32_t *)stream_data.data(), STREAM_WRITE, frame,
+                    &written);
+        stream_write_buffer(queue, stream_buffer, offset, stream_data.data(),
+                            STREAM_WRITE, &written);
+        written.streamed += STREAM_WRITE;
+      }
+    }
+    belt_finish(&belt);
+    double stream_ms = ms_since(stream_begin);
+
+    auto begin = std::chrono::steady_clock::now();
+
     WGPUTextureView target = wgpuSwapChainGetCurrentTextureView(swapchain);
 
     WGPURenderPassEncoder pass = nullptr;
@@ -215,20 +818,61 @@ int main() {
       pass = wgpuCommandEncoderBeginRenderPass(encoder, &desc);
     }
 
-    wgpuRenderPassEncoderSetPipeline(pass, pipeline);
-    wgpuRenderPassEncoderSetVertexBuffer(pass, 0, vbuf, 0, WGPU_WHOLE_SIZE);
-    wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+    bool compiling = !pipeline.done;
+    if (pipeline.pipeline) {
+      wgpuRenderPassEncoderSetPipeline(pass, pipeline.pipeline);
+      wgpuRenderPassEncoderSetVertexBuffer(pass, 0, vbuf, 0, WGPU_WHOLE_SIZE);
+      wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+    }
+
+    for (int i = 0; i < opts.pipelines; i++) {
+      compiling |= !batch[i].done;
+      if (batch[i].pipeline) {
+        uint64_t size = 3 * sizeof(Vertex);
+        set_pipeline(pass, batch[i].pipeline);
+        set_vertex_buffer(pass, batch_vbuf, i * size, size);
+        draw(pass, 3);
+      }
+    }
+
+    if (scene.count > 0) {
+      if (use_bundle) {
+        wgpuRenderPassEncoderExecuteBundles(pass, 1, &bundle.bundle);
+      } else {
+        encode_static_draws(pass, scene);
+      }
+    }
 
     wgpuRenderPassEncoderEnd(pass);
 
     WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, NULL);
 
+    if (scene.count > 0) {
+      (use_bundle ? bundle_ms : encode_ms).push_back(ms_since(begin));
+    }
+
+    stream_begin = std::chrono::steady_clock::now();
     wgpuQueueSubmit(queue, 1, &command);
+    if (stream_bytes > 0) {
+      stream_ms += ms_since(stream_begin);
+      (use_belt ? staged : written).ms.push_back(stream_ms);
+    }
+    belt_recall(&belt);
 
     wgpuCommandEncoderRelease(encoder);
     wgpuTextureViewRelease(target);
     wgpuCommandBufferRelease(command);
 
     wgpuSwapChainPresent(swapchain);
+    if (frame == 0) {
+      first_frame_ms = ms_since(startup);
+    }
+    frames_while_compiling += compiling;
+    frame++;
   }
+
+  print_startup_stats(adapter_ms, device_ms, first_frame_ms, pipeline, batch,
+                      frames_while_compiling);
+  print_static_stats(scene, bundle, &bundle_ms, &encode_ms);
+  print_stream_stats(opts.stream_mb, belt, &staged, &written);
 }
@@ -1,30 +1,1629 @@
 // cl /std:c++17 /nologo /Zi /Iinclude sokol.cpp
+// g++ -std=c++17 -O2 -Iinclude -DSOKOL_DUMMY_BACKEND -DSOKOL_DEBUG sokol.cpp -o sokol-dummy
+// g++ -std=c++17 -O2 -Iinclude -DHEADLESS_EGL sokol.cpp -o sokol-egl -lEGL -lGLESv2
+//
+// sokol [--pipelines N] [--buffers N] [--draws N]
+//       [--stream N] [--stream-triangles N] [--stream-chunks N]
+//       [--sgl N] [--sgl-batch N] [--sgl-break-every N]
+//       [--sgl-max-vertices N] [--sgl-max-commands N]
+//       [--profile] [--profile-csv out.csv] [--profile-print N]
+//       [--track-memory] [--memory-pools] [--memory-cap MB]
+//       [--post blur,tonemap,downsample,...] [--post-format FORMAT]
+//       [--pool-stats] [--pool-record out.txt] [--pool-load in.txt]
+//       [--churn N]
+// sokol-dummy [--frames N] [--calls N] + the options above
+// sokol-egl [--frames N] [--size WxH] [--sync-timing] + the options above
+//
+// sokol-dummy has no window or GPU and times init() and frame() in a loop,
+// with validation on and off. sokol-egl renders into an FBO on a surfaceless
+// EGL context (Linux only).
+//
+// --pipelines N       scene of N pipelines, --buffers N vertex buffers and
+//                     --draws N draws per frame
+// --stream N          N-vertex SG_USAGE_STREAM buffer, refilled every frame in
+//                     --stream-chunks appends of --stream-triangles in total
+// --sgl N             N triangles through sokol_gl vs one retained sg_draw,
+//                     --sgl-batch per batch, broken up every --sgl-break-every
+// --sgl-max-*         vertices and commands per sokol_gl context
+// --post CHAIN        offscreen scene and fullscreen passes, --post-format
+//                     rgba16f (default), rgba8 or rg11b10f
+// --sync-timing       glFinish around each --post pass, to time it on the GPU
+// --profile           sokol_gfx calls and frame time histogram, every
+//                     --profile-print N frames, --profile-csv per frame
+// --pool-stats        live resources and high-water marks per pool,
+//                     --pool-record saves them, --pool-load sizes pools from
+//                     them
+// --churn N           create and destroy N buffers and images per frame
+// --track-memory      live and peak bytes per library through the allocator
+//                     hooks, --memory-pools arenas, --memory-cap MB limit
+// --frames N          timed frames (dummy and EGL builds)
+// --calls N           isolated sg_apply_bindings/sg_draw calls (dummy build)
+// --size WxH          FBO size (EGL build, default 800x600)
 
 #define SOKOL_IMPL
+#if defined(SOKOL_DUMMY_BACKEND)
+#define HEADLESS
+#elif defined(HEADLESS_EGL)
+#define HEADLESS
+#define SOKOL_GLES3
+#define SOKOL_EXTERNAL_GL_LOADER
+#else
 #define SOKOL_GLCORE33
 #define SOKOL_WIN32_FORCE_MAIN
+#endif
+#define SOKOL_TRACE_HOOKS
 
+#if !defined(HEADLESS)
 #include <sokol_app.h>
+#endif
+#if defined(HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#endif
 #include <sokol_gfx.h>
+#include <sokol_gl.h>
+#if !defined(HEADLESS)
 #include <sokol_glue.h>
+#endif
 #include <sokol_log.h>
+#include <bench.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
 
-sg_buffer vbuf;
-sg_pipeline pip;
+// GLES3 needs its own version line, and fragment shaders have no default
+// float precision there.
+#if defined(SOKOL_GLES3)
+#define GLSL_VERSION "#version 300 es\nprecision highp float;\n"
+#else
+#define GLSL_VERSION "#version 330 core\n"
+#endif
+
+struct Options {
+  int pipelines;
+  int buffers;
+  int draws;
+  bool disable_validation;
+
+  int stream;
+  int stream_triangles;
+  int stream_chunks;
+
+  int sgl;
+  int sgl_batch;
+  int sgl_break_every;
+  int sgl_max_vertices;
+  int sgl_max_commands;
+
+  bool profile;
+  const char *profile_csv;
+  int profile_print;
+
+  const char *post;
+  sg_pixel_format post_format;
+
+  bool pool_stats;
+  const char *pool_record;
+  const char *pool_load;
+  int churn;
+
+  bool track_memory;
+  bool memory_pools;
+  size_t memory_cap;
+
+  // headless builds only
+  int width;
+  int height;
+  int frames;
+  int calls;
+  bool sync_timing;
+};
+
+Options opts = {};
+
+bool parse_options(int argc, char **argv) {
+  opts.pipelines = 1;
+  opts.buffers = 1;
+  opts.draws = 1;
+  opts.stream_chunks = 4;
+  opts.sgl_batch = 1;
+  opts.sgl_max_vertices = 64 * 1024;
+  opts.sgl_max_commands = 16 * 1024;
+  opts.post_format = SG_PIXELFORMAT_RGBA16F;
+  opts.profile_print = 600;
+  opts.width = 800;
+  opts.height = 600;
+  opts.frames = 1000;
+  opts.calls = 1000000;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (strcmp(arg, "--pipelines") == 0 && next) {
+      opts.pipelines = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--buffers") == 0 && next) {
+      opts.buffers = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--draws") == 0 && next) {
+      opts.draws = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--stream") == 0 && next) {
+      opts.stream = std::max(atoi(next), 3);
+      i++;
+    } else if (strcmp(arg, "--stream-triangles") == 0 && next) {
+      opts.stream_triangles = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--stream-chunks") == 0 && next) {
+      opts.stream_chunks = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--sgl") == 0 && next) {
+      opts.sgl = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--sgl-batch") == 0 && next) {
+      opts.sgl_batch = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--sgl-break-every") == 0 && next) {
+      opts.sgl_break_every = std::max(atoi(next), 0);
+      i++;
+    } else if (strcmp(arg, "--sgl-max-vertices") == 0 && next) {
+      opts.sgl_max_vertices = std::max(atoi(next), 3);
+      i++;
+    } else if (strcmp(arg, "--sgl-max-commands") == 0 && next) {
+      opts.sgl_max_commands = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--post") == 0 && next) {
+      opts.post = next;
+      i++;
+    } else if (strcmp(arg, "--post-format") == 0 && next) {
+      if (strcmp(next, "rgba8") == 0) {
+        opts.post_format = SG_PIXELFORMAT_RGBA8;
+      } else if (strcmp(next, "rgba16f") == 0) {
+        opts.post_format = SG_PIXELFORMAT_RGBA16F;
+      } else if (strcmp(next, "rg11b10f") == 0) {
+        opts.post_format = SG_PIXELFORMAT_RG11B10F;
+      } else {
+        return false;
+      }
+      i++;
+    } else if (strcmp(arg, "--frames") == 0 && next) {
+      opts.frames = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--size") == 0 && next) {
+      if (sscanf(next, "%dx%d", &opts.width, &opts.height) != 2 ||
+          opts.width <= 0 || opts.height <= 0) {
+        return false;
+      }
+      i++;
+    } else if (strcmp(arg, "--calls") == 0 && next) {
+      opts.calls = std::max(atoi(next), 1);
+      i++;
+#if defined(HEADLESS_EGL)
+    } else if (strcmp(arg, "--sync-timing") == 0) {
+      opts.sync_timing = true;
+#endif
+    } else if (strcmp(arg, "--profile") == 0) {
+      opts.profile = true;
+    } else if (strcmp(arg, "--profile-csv") == 0 && next) {
+      opts.profile = true;
+      opts.profile_csv = next;
+      i++;
+    } else if (strcmp(arg, "--profile-print") == 0 && next) {
+      opts.profile = true;
+      opts.profile_print = atoi(next);
+      i++;
+    } else if (strcmp(arg, "--pool-stats") == 0) {
+      opts.pool_stats = true;
+    } else if (strcmp(arg, "--pool-record") == 0 && next) {
+      opts.pool_stats = true;
+      opts.pool_record = next;
+      i++;
+    } else if (strcmp(arg, "--pool-load") == 0 && next) {
+      opts.pool_load = next;
+      i++;
+    } else if (strcmp(arg, "--churn") == 0 && next) {
+      opts.churn = std::max(atoi(next), 1);
+      i++;
+    } else if (strcmp(arg, "--track-memory") == 0) {
+      opts.track_memory = true;
+    } else if (strcmp(arg, "--memory-pools") == 0) {
+      opts.track_memory = true;
+      opts.memory_pools = true;
+    } else if (strcmp(arg, "--memory-cap") == 0 && next) {
+      opts.track_memory = true;
+      opts.memory_cap = (size_t)std::max(atoi(next), 1) * 1024 * 1024;
+      i++;
+    } else {
+      return false;
+    }
+  }
+
+  if (opts.stream > 0 && opts.stream_triangles == 0) {
+    opts.stream_triangles = opts.stream / 3;
+  }
+
+  return true;
+}
+
+// Per-frame counters, filled in by the trace hooks between two sg_commit
+// calls.
+struct FrameStats {
+  int apply_pipeline;
+  int apply_bindings;
+  int draw;
+  int update_buffer;
+  int append_buffer;
+  int update_image;
+  long long bytes_uploaded;
+  double frame_ms;
+};
+
+// Upper bounds in ms of the frame-time histogram buckets. Anything slower
+// lands in one extra bucket at the end.
+constexpr double HISTOGRAM_BOUNDS[] = {1,  2,  4,  8,  12,  16.7,
+                                       20, 25, 33.4, 50, 100};
+constexpr int HISTOGRAM_BUCKETS =
+    sizeof(HISTOGRAM_BOUNDS) / sizeof(HISTOGRAM_BOUNDS[0]) + 1;
+constexpr int HISTOGRAM_FRAMES = 600;
+
+struct Profiler {
+  sg_trace_hooks prev;
+  FrameStats current;
+  std::chrono::steady_clock::time_point last_commit;
+  long long frame;
+
+  // ring of the last HISTOGRAM_FRAMES frames and their bucket counts
+  FrameStats history[HISTOGRAM_FRAMES];
+  int buckets[HISTOGRAM_BUCKETS];
+
+  FILE *csv;
+};
+
+Profiler profiler = {};
+
+int histogram_bucket(double ms) {
+  int i = 0;
+  while (i < HISTOGRAM_BUCKETS - 1 && ms > HISTOGRAM_BOUNDS[i]) {
+    i++;
+  }
+  return i;
+}
+
+void print_profile() {
+  int frames = (int)(profiler.frame < HISTOGRAM_FRAMES ? profiler.frame
+                                                        : HISTOGRAM_FRAMES);
+  if (frames == 0) {
+    return;
+  }
+
+  FrameStats sum = {};
+  FrameStats peak = {};
+  for (int i = 0; i < frames; i++) {
+    const FrameStats &f = profiler.history[i];
+    sum.apply_pipeline += f.apply_pipeline;
+    sum.apply_bindings += f.apply_bindings;
+    sum.draw += f.draw;
+    sum.update_buffer += f.update_buffer + f.append_buffer;
+    sum.bytes_uploaded += f.bytes_uploaded;
+    sum.frame_ms += f.frame_ms;
+    peak.draw = f.draw > peak.draw ? f.draw : peak.draw;
+    peak.bytes_uploaded = f.bytes_uploaded > peak.bytes_uploaded
+                              ? f.bytes_uploaded
+                              : peak.bytes_uploaded;
+    peak.frame_ms = f.frame_ms > peak.frame_ms ? f.frame_ms : peak.frame_ms;
+  }
+
+  printf("last %d frames: %.3f ms avg, %.3f ms max\n", frames,
+         sum.frame_ms / frames, peak.frame_ms);
+  printf("  per frame: %.1f apply_pipeline, %.1f apply_bindings, "
+         "%.1f draw (max %d), %.1f buffer updates, %.0f bytes (max %lld)\n",
+         (double)sum.apply_pipeline / frames,
+         (double)sum.apply_bindings / frames, (double)sum.draw / frames,
+         peak.draw, (double)sum.update_buffer / frames,
+         (double)sum.bytes_uploaded / frames, peak.bytes_uploaded);
+
+  for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    if (profiler.buckets[i] == 0) {
+      continue;
+    }
+
+    char label[32];
+    if (i < HISTOGRAM_BUCKETS - 1) {
+      snprintf(label, sizeof(label), "<= %.1f ms", HISTOGRAM_BOUNDS[i]);
+    } else {
+      snprintf(label, sizeof(label), " > %.1f ms", HISTOGRAM_BOUNDS[i - 1]);
+    }
+
+    int bar = profiler.buckets[i] * 50 / frames;
+    printf("  %-12s %5d %.*s\n", label, profiler.buckets[i], bar,
+           "##################################################");
+  }
+}
+
+void trace_apply_pipeline(sg_pipeline pip, void *) {
+  profiler.current.apply_pipeline++;
+  if (profiler.prev.apply_pipeline) {
+    profiler.prev.apply_pipeline(pip, profiler.prev.user_data);
+  }
+}
+
+void trace_apply_bindings(const sg_bindings *bindings, void *) {
+  profiler.current.apply_bindings++;
+  if (profiler.prev.apply_bindings) {
+    profiler.prev.apply_bindings(bindings, profiler.prev.user_data);
+  }
+}
+
+void trace_draw(int base_element, int num_elements, int num_instances,
+                void *) {
+  profiler.current.draw++;
+  if (profiler.prev.draw) {
+    profiler.prev.draw(base_element, num_elements, num_instances,
+                       profiler.prev.user_data);
+  }
+}
+
+void trace_update_buffer(sg_buffer buf, const sg_range *data, void *) {
+  profiler.current.update_buffer++;
+  profiler.current.bytes_uploaded += data->size;
+  if (profiler.prev.update_buffer) {
+    profiler.prev.update_buffer(buf, data, profiler.prev.user_data);
+  }
+}
+
+void trace_append_buffer(sg_buffer buf, const sg_range *data, int result,
+                         void *) {
+  profiler.current.append_buffer++;
+  profiler.current.bytes_uploaded += data->size;
+  if (profiler.prev.append_buffer) {
+    profiler.prev.append_buffer(buf, data, result, profiler.prev.user_data);
+  }
+}
+
+void trace_update_image(sg_image img, const sg_image_data *data, void *) {
+  profiler.current.update_image++;
+  for (int face = 0; face < SG_CUBEFACE_NUM; face++) {
+    for (int mip = 0; mip < SG_MAX_MIPMAPS; mip++) {
+      profiler.current.bytes_uploaded += data->subimage[face][mip].size;
+    }
+  }
+  if (profiler.prev.update_image) {
+    profiler.prev.update_image(img, data, profiler.prev.user_data);
+  }
+}
+
+void trace_commit(void *) {
+  auto now = std::chrono::steady_clock::now();
+  FrameStats &f = profiler.current;
+  f.frame_ms =
+      std::chrono::duration<double, std::milli>(now - profiler.last_commit)
+          .count();
+  profiler.last_commit = now;
+
+  // the first commit only starts the clock
+  if (profiler.frame >= 0) {
+    FrameStats &slot = profiler.history[profiler.frame % HISTOGRAM_FRAMES];
+    if (profiler.frame >= HISTOGRAM_FRAMES) {
+      profiler.buckets[histogram_bucket(slot.frame_ms)]--;
+    }
+    slot = f;
+    profiler.buckets[histogram_bucket(f.frame_ms)]++;
+
+    if (profiler.csv) {
+      fprintf(profiler.csv, "%lld,%.4f,%d,%d,%d,%d,%d,%d,%lld\n",
+              profiler.frame, f.frame_ms, f.apply_pipeline, f.apply_bindings,
+              f.draw, f.update_buffer, f.append_buffer, f.update_image,
+              f.bytes_uploaded);
+    }
+  }
+
+  profiler.frame++;
+  f = {};
+
+  if (opts.profile_print > 0 && profiler.frame > 0 &&
+      profiler.frame % opts.profile_print == 0) {
+    print_profile();
+  }
+
+  if (profiler.prev.commit) {
+    profiler.prev.commit(profiler.prev.user_data);
+  }
+}
+
+void install_profiler() {
+  profiler = {};
+  profiler.frame = -1;
+  profiler.last_commit = std::chrono::steady_clock::now();
+
+  if (opts.profile_csv) {
+    profiler.csv = fopen(opts.profile_csv, "w");
+    if (profiler.csv) {
+      fprintf(profiler.csv, "frame,frame_ms,apply_pipeline,apply_bindings,"
+                            "draw,update_buffer,append_buffer,update_image,"
+                            "bytes_uploaded\n");
+    } else {
+      fprintf(stderr, "could not open %s\n", opts.profile_csv);
+    }
+  }
+
+  sg_trace_hooks hooks = {};
+  hooks.apply_pipeline = trace_apply_pipeline;
+  hooks.apply_bindings = trace_apply_bindings;
+  hooks.draw = trace_draw;
+  hooks.update_buffer = trace_update_buffer;
+  hooks.append_buffer = trace_append_buffer;
+  hooks.update_image = trace_update_image;
+  hooks.commit = trace_commit;
+  profiler.prev = sg_install_trace_hooks(&hooks);
+}
+
+void uninstall_profiler() {
+  sg_install_trace_hooks(&profiler.prev);
+  if (opts.profile) {
+    print_profile();
+  }
+  if (profiler.csv) {
+    fclose(profiler.csv);
+  }
+}
+
+enum PoolKind {
+  POOL_BUFFER,
+  POOL_IMAGE,
+  POOL_SHADER,
+  POOL_PIPELINE,
+  POOL_PASS,
+  NUM_POOLS,
+};
+
+const char *POOL_NAMES[NUM_POOLS] = {"buffer", "image", "shader", "pipeline",
+                                     "pass"};
+
+// Warns once a pool is this full, and again only after it has drained below
+// POOL_REARM_PERCENT.
+constexpr int POOL_WARN_PERCENT = 90;
+constexpr int POOL_REARM_PERCENT = 75;
+
+struct PoolStats {
+  int size;
+  int live;
+  int high_water;
+  long long made;
+  long long destroyed;
+  long long exhausted;
+  bool warned;
+};
+
+// Only sees resources made with sg_make_*; nothing in this file uses the
+// sg_alloc_*/sg_init_* path.
+struct PoolMonitor {
+  sg_trace_hooks prev;
+  PoolStats pools[NUM_POOLS];
+};
+
+PoolMonitor pool_monitor = {};
+
+void pool_made(PoolKind kind, uint32_t id) {
+  PoolStats &p = pool_monitor.pools[kind];
+  if (id == SG_INVALID_ID) {
+    p.exhausted++;
+    fprintf(stderr, "sokol_gfx %s pool exhausted (%d/%d)\n", POOL_NAMES[kind],
+            p.live, p.size);
+    return;
+  }
+
+  p.made++;
+  p.live++;
+  if (p.live > p.high_water) {
+    p.high_water = p.live;
+  }
+
+  if (!p.warned && p.live * 100 >= p.size * POOL_WARN_PERCENT) {
+    p.warned = true;
+    fprintf(stderr, "sokol_gfx %s pool at %d%% (%d/%d)\n", POOL_NAMES[kind],
+            p.live * 100 / p.size, p.live, p.size);
+  }
+}
+
+// Destroying an invalid or stale handle is a no-op in sokol_gfx, so it must
+// not count.
+void pool_destroyed(PoolKind kind, sg_resource_state state) {
+  if (state == SG_RESOURCESTATE_INVALID) {
+    return;
+  }
+
+  PoolStats &p = pool_monitor.pools[kind];
+  p.destroyed++;
+  p.live--;
+  if (p.warned && p.live * 100 < p.size * POOL_REARM_PERCENT) {
+    p.warned = false;
+  }
+}
+
+void trace_make_buffer(const sg_buffer_desc *desc, sg_buffer result, void *) {
+  pool_made(POOL_BUFFER, result.id);
+  if (pool_monitor.prev.make_buffer) {
+    pool_monitor.prev.make_buffer(desc, result, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_make_image(const sg_image_desc *desc, sg_image result, void *) {
+  pool_made(POOL_IMAGE, result.id);
+  if (pool_monitor.prev.make_image) {
+    pool_monitor.prev.make_image(desc, result, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_make_shader(const sg_shader_desc *desc, sg_shader result, void *) {
+  pool_made(POOL_SHADER, result.id);
+  if (pool_monitor.prev.make_shader) {
+    pool_monitor.prev.make_shader(desc, result, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_make_pipeline(const sg_pipeline_desc *desc, sg_pipeline result,
+                         void *) {
+  pool_made(POOL_PIPELINE, result.id);
+  if (pool_monitor.prev.make_pipeline) {
+    pool_monitor.prev.make_pipeline(desc, result,
+                                    pool_monitor.prev.user_data);
+  }
+}
+
+void trace_make_pass(const sg_pass_desc *desc, sg_pass result, void *) {
+  pool_made(POOL_PASS, result.id);
+  if (pool_monitor.prev.make_pass) {
+    pool_monitor.prev.make_pass(desc, result, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_destroy_buffer(sg_buffer buf, void *) {
+  pool_destroyed(POOL_BUFFER, sg_query_buffer_state(buf));
+  if (pool_monitor.prev.destroy_buffer) {
+    pool_monitor.prev.destroy_buffer(buf, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_destroy_image(sg_image img, void *) {
+  pool_destroyed(POOL_IMAGE, sg_query_image_state(img));
+  if (pool_monitor.prev.destroy_image) {
+    pool_monitor.prev.destroy_image(img, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_destroy_shader(sg_shader shd, void *) {
+  pool_destroyed(POOL_SHADER, sg_query_shader_state(shd));
+  if (pool_monitor.prev.destroy_shader) {
+    pool_monitor.prev.destroy_shader(shd, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_destroy_pipeline(sg_pipeline pip, void *) {
+  pool_destroyed(POOL_PIPELINE, sg_query_pipeline_state(pip));
+  if (pool_monitor.prev.destroy_pipeline) {
+    pool_monitor.prev.destroy_pipeline(pip, pool_monitor.prev.user_data);
+  }
+}
+
+void trace_destroy_pass(sg_pass pass, void *) {
+  pool_destroyed(POOL_PASS, sg_query_pass_state(pass));
+  if (pool_monitor.prev.destroy_pass) {
+    pool_monitor.prev.destroy_pass(pass, pool_monitor.prev.user_data);
+  }
+}
+
+// Installs on top of whatever hooks are already there (the profiler's), and
+// keeps those in place for everything it doesn't hook itself.
+void install_pool_monitor() {
+  pool_monitor = {};
+
+  sg_desc desc = sg_query_desc();
+  pool_monitor.pools[POOL_BUFFER].size = desc.buffer_pool_size;
+  pool_monitor.pools[POOL_IMAGE].size = desc.image_pool_size;
+  pool_monitor.pools[POOL_SHADER].size = desc.shader_pool_size;
+  pool_monitor.pools[POOL_PIPELINE].size = desc.pipeline_pool_size;
+  pool_monitor.pools[POOL_PASS].size = desc.pass_pool_size;
+
+  sg_trace_hooks none = {};
+  pool_monitor.prev = sg_install_trace_hooks(&none);
+
+  sg_trace_hooks hooks = pool_monitor.prev;
+  hooks.make_buffer = trace_make_buffer;
+  hooks.make_image = trace_make_image;
+  hooks.make_shader = trace_make_shader;
+  hooks.make_pipeline = trace_make_pipeline;
+  hooks.make_pass = trace_make_pass;
+  hooks.destroy_buffer = trace_destroy_buffer;
+  hooks.destroy_image = trace_destroy_image;
+  hooks.destroy_shader = trace_destroy_shader;
+  hooks.destroy_pipeline = trace_destroy_pipeline;
+  hooks.destroy_pass = trace_destroy_pass;
+  sg_install_trace_hooks(&hooks);
+}
+
+void uninstall_pool_monitor() {
+  sg_install_trace_hooks(&pool_monitor.prev);
+
+  printf("pools:\n");
+  for (int i = 0; i < NUM_POOLS; i++) {
+    const PoolStats &p = pool_monitor.pools[i];
+    printf("  %-8s  size %5d, high-water %5d (%3d%%), %lld made, "
+           "%lld destroyed, %lld exhausted\n",
+           POOL_NAMES[i], p.size, p.high_water, p.high_water * 100 / p.size,
+           p.made, p.destroyed, p.exhausted);
+  }
+
+  if (opts.pool_record) {
+    FILE *f = fopen(opts.pool_record, "w");
+    if (!f) {
+      fprintf(stderr, "could not open %s\n", opts.pool_record);
+      return;
+    }
+    for (int i = 0; i < NUM_POOLS; i++) {
+      // an exhausted pool needed more than it had, so record what was asked
+      const PoolStats &p = pool_monitor.pools[i];
+      fprintf(f, "%s %lld\n", POOL_NAMES[i], p.high_water + p.exhausted);
+    }
+    fclose(f);
+  }
+}
+
+// Reads "name high-water" lines written by --pool-record and sizes each pool
+// it names with 25% headroom. Pools the file doesn't mention keep their size.
+void load_pool_profile(sg_desc *desc) {
+  FILE *f = fopen(opts.pool_load, "r");
+  if (!f) {
+    fprintf(stderr, "could not open %s\n", opts.pool_load);
+    return;
+  }
+
+  int *sizes[NUM_POOLS] = {&desc->buffer_pool_size, &desc->image_pool_size,
+                           &desc->shader_pool_size, &desc->pipeline_pool_size,
+                           &desc->pass_pool_size};
+
+  printf("pool sizes from %s:", opts.pool_load);
+  char name[32];
+  int high_water = 0;
+  while (fscanf(f, "%31s %d", name, &high_water) == 2) {
+    for (int i = 0; i < NUM_POOLS; i++) {
+      if (strcmp(name, POOL_NAMES[i]) == 0) {
+        *sizes[i] = std::max(high_water + high_water / 4 + 4, 1);
+        printf(" %s %d", name, *sizes[i]);
+      }
+    }
+  }
+  printf("\n");
+  fclose(f);
+}
+
+// Every tracked allocation is prefixed with its requested size and the arena
+// it came from, since the sokol free hooks don't pass the size back. 16 bytes
+// keep the returned pointer as aligned as malloc's.
+struct alignas(16) AllocHeader {
+  size_t size;
+  int pool;
+};
+
+// Requests up to these sizes are served from arenas with --memory-pools.
+// sokol allocates mostly once at setup, but pool slots, small descriptor
+// copies and shader logs are all in this range.
+constexpr size_t POOL_CLASSES[] = {64, 256, 1024};
+constexpr int NUM_POOL_CLASSES = sizeof(POOL_CLASSES) / sizeof(POOL_CLASSES[0]);
+constexpr size_t POOL_CHUNK_SIZE = 64 * 1024;
+
+struct PoolArena {
+  void *free_list;
+  std::vector<void *> chunks;
+};
+
+struct MemoryTracker {
+  const char *name = nullptr;
+  long long live = 0;
+  long long peak = 0;
+  long long allocs = 0;
+  long long frees = 0;
+  long long pooled = 0;
+  long long refused = 0;
+};
+
+MemoryTracker gfx_memory = {"sokol_gfx"};
+MemoryTracker gl_memory = {"sokol_gl"};
+MemoryTracker app_memory = {"sokol_app"};
+PoolArena pool_arenas[NUM_POOL_CLASSES];
+
+// The cap covers all three libraries together.
+long long total_live_memory() {
+  return gfx_memory.live + gl_memory.live + app_memory.live;
+}
+
+int pool_class(size_t size) {
+  for (int i = 0; i < NUM_POOL_CLASSES; i++) {
+    if (size <= POOL_CLASSES[i]) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void *pool_alloc(int pool) {
+  PoolArena &arena = pool_arenas[pool];
+  if (!arena.free_list) {
+    size_t block = sizeof(AllocHeader) + POOL_CLASSES[pool];
+    char *chunk = (char *)malloc(POOL_CHUNK_SIZE);
+    if (!chunk) {
+      return nullptr;
+    }
+    arena.chunks.push_back(chunk);
+
+    // thread the new chunk onto the free list, back to front
+    for (size_t offset = (POOL_CHUNK_SIZE / block - 1) * block;;
+         offset -= block) {
+      *(void **)(chunk + offset) = arena.free_list;
+      arena.free_list = chunk + offset;
+      if (offset == 0) {
+        break;
+      }
+    }
+  }
+
+  void *block = arena.free_list;
+  arena.free_list = *(void **)block;
+  return block;
+}
+
+void *tracked_alloc(size_t size, void *user_data) {
+  MemoryTracker *tracker = (MemoryTracker *)user_data;
+
+  if (opts.memory_cap > 0 &&
+      total_live_memory() + (long long)size > (long long)opts.memory_cap) {
+    tracker->refused++;
+    fprintf(stderr, "%s: refused %zu bytes, %.1f MB cap reached\n",
+            tracker->name, size, opts.memory_cap / (1024.0 * 1024.0));
+    return nullptr;
+  }
+
+  int pool = opts.memory_pools ? pool_class(size) : -1;
+  AllocHeader *header = nullptr;
+  if (pool >= 0) {
+    header = (AllocHeader *)pool_alloc(pool);
+  } else {
+    header = (AllocHeader *)malloc(sizeof(AllocHeader) + size);
+  }
+  if (!header) {
+    return nullptr;
+  }
+
+  header->size = size;
+  header->pool = pool;
+  if (pool >= 0) {
+    tracker->pooled++;
+  }
+  tracker->live += (long long)size;
+  if (tracker->live > tracker->peak) {
+    tracker->peak = tracker->live;
+  }
+  tracker->allocs++;
+  return header + 1;
+}
+
+void tracked_free(void *ptr, void *user_data) {
+  if (!ptr) {
+    return;
+  }
+
+  MemoryTracker *tracker = (MemoryTracker *)user_data;
+  AllocHeader *header = (AllocHeader *)ptr - 1;
+  tracker->live -= (long long)header->size;
+  tracker->frees++;
+
+  if (header->pool >= 0) {
+    PoolArena &arena = pool_arenas[header->pool];
+    *(void **)header = arena.free_list;
+    arena.free_list = header;
+  } else {
+    free(header);
+  }
+}
+
+template <typename Allocator>
+Allocator tracking_allocator(MemoryTracker *tracker) {
+  Allocator allocator = {};
+  if (opts.track_memory) {
+    allocator.alloc = tracked_alloc;
+    allocator.free = tracked_free;
+    allocator.user_data = tracker;
+  }
+  return allocator;
+}
+
+// Starts the counts over, so the dummy bench's second run doesn't report the
+// first one's allocations too. The arenas are only released once nothing
+// allocated from them is still live.
+void reset_memory_stats() {
+  for (MemoryTracker *t : {&gfx_memory, &gl_memory, &app_memory}) {
+    *t = {t->name, t->live, t->live};
+  }
+
+  if (total_live_memory() == 0) {
+    for (PoolArena &arena : pool_arenas) {
+      for (void *chunk : arena.chunks) {
+        free(chunk);
+      }
+      arena = {};
+    }
+  }
+}
+
+void print_memory_stats() {
+  printf("memory");
+  if (opts.memory_cap > 0) {
+    printf(" (%.1f MB cap)", opts.memory_cap / (1024.0 * 1024.0));
+  }
+  printf(":\n");
+
+  for (const MemoryTracker *t : {&gfx_memory, &gl_memory, &app_memory}) {
+    if (t->allocs == 0) {
+      continue;
+    }
+    printf("  %-9s  %lld bytes live, %.2f MB peak, %lld allocations "
+           "(%lld pooled), %lld frees, %lld refused\n",
+           t->name, t->live, t->peak / (1024.0 * 1024.0), t->allocs,
+           t->pooled, t->frees, t->refused);
+  }
+
+  if (opts.memory_pools) {
+    for (int i = 0; i < NUM_POOL_CLASSES; i++) {
+      printf("  %4zu-byte arena: %zu KB reserved\n", POOL_CLASSES[i],
+             pool_arenas[i].chunks.size() * POOL_CHUNK_SIZE / 1024);
+    }
+  }
+}
+
+int frame_width() {
+#if defined(HEADLESS)
+  return opts.width;
+#else
+  return sapp_width();
+#endif
+}
+
+int frame_height() {
+#if defined(HEADLESS)
+  return opts.height;
+#else
+  return sapp_height();
+#endif
+}
+
+struct Vertex {
+  float position[3];
+  float color[4];
+};
+
+std::vector<sg_buffer> vbufs;
+std::vector<sg_pipeline> pips;
+
+struct Stream {
+  sg_buffer buf;
+  std::vector<Vertex> vertices;
+  long long frame;
+  long long bytes;
+  long long overflows;
+  long long dropped_triangles;
+  double gen_ms;
+  double frame_ms;
+};
+
+Stream stream = {};
+
+void init_stream() {
+  sg_buffer_desc desc = {};
+  desc.size = sizeof(Vertex) * opts.stream;
+  desc.usage = SG_USAGE_STREAM;
+  desc.label = "stream";
+  stream.buf = sg_make_buffer(&desc);
+  stream.vertices.resize((size_t)opts.stream_triangles * 3);
+}
+
+// Spins every triangle around its own spot on a grid, with a hue that
+// drifts over time.
+void generate_triangles(Vertex *out, int count, float t) {
+  int side = 1;
+  while (side * side < count) {
+    side++;
+  }
+
+  float cell = 2.0f / side;
+  float radius = cell * 0.45f;
+  for (int i = 0; i < count; i++) {
+    float cx = -1.0f + cell * (i % side + 0.5f);
+    float cy = -1.0f + cell * (i / side + 0.5f);
+    float angle = t + i * 0.01f;
+    float r = 0.5f + 0.5f * sinf(t + i * 0.001f);
+    float g = 0.5f + 0.5f * sinf(t + i * 0.001f + 2.1f);
+    float b = 0.5f + 0.5f * sinf(t + i * 0.001f + 4.2f);
+
+    Vertex *v = &out[(size_t)i * 3];
+    for (int k = 0; k < 3; k++) {
+      float a = angle + k * 2.0944f;
+      v[k] = {{cx + radius * cosf(a), cy + radius * sinf(a), 0.0f},
+              {r, g, b, 1.0f}};
+    }
+  }
+}
+
+void draw_stream() {
+  auto begin = std::chrono::steady_clock::now();
+  generate_triangles(stream.vertices.data(), opts.stream_triangles,
+                     stream.frame / 60.0f);
+  auto generated = std::chrono::steady_clock::now();
+
+  sg_apply_pipeline(pips[0]);
+
+  size_t capacity = sizeof(Vertex) * opts.stream;
+  size_t appended = 0;
+
+  int triangles = opts.stream_triangles;
+  int chunk = (triangles + opts.stream_chunks - 1) / opts.stream_chunks;
+  for (int first = 0; first < triangles; first += chunk) {
+    int count = triangles - first < chunk ? triangles - first : chunk;
+
+    sg_range data = {&stream.vertices[(size_t)first * 3],
+                     sizeof(Vertex) * 3 * (size_t)count};
+
+    // the validation layer panics on appends past the end instead of
+    // flagging an overflow, so those are caught up front as well
+    bool overflow = appended + data.size > capacity;
+    int offset = 0;
+    if (!overflow) {
+      offset = sg_append_buffer(stream.buf, &data);
+      overflow = sg_query_buffer_overflow(stream.buf);
+    }
+
+    if (overflow) {
+      // the rest of this frame's appends would be dropped as well
+      stream.overflows++;
+      stream.dropped_triangles += triangles - first;
+      break;
+    }
+    appended += data.size;
+    stream.bytes += data.size;
+
+    sg_bindings bind = {};
+    bind.vertex_buffers[0] = stream.buf;
+    bind.vertex_buffer_offsets[0] = offset;
+    sg_apply_bindings(&bind);
+    sg_draw(0, count * 3, 1);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  stream.gen_ms +=
+      std::chrono::duration<double, std::milli>(generated - begin).count();
+  stream.frame_ms +=
+      std::chrono::duration<double, std::milli>(end - begin).count();
+  stream.frame++;
+}
+
+// Contexts beyond the default one that --sgl may spill into. Each of them
+// needs one sg_buffer and a sg_pipeline per primitive type.
+constexpr int SGL_MAX_CONTEXTS = 16;
+constexpr int SGL_PIPELINES_PER_CONTEXT = 5;
+
+struct Immediate {
+  std::vector<Vertex> vertices;
+  sg_buffer retained;
+  sgl_context contexts[SGL_MAX_CONTEXTS];
+  int num_contexts;
+
+  long long frame;
+  long long batches;
+  long long draws;
+  long long splits;
+  long long dropped_frames;
+  double retained_ms;
+  double submit_ms;
+  double draw_ms;
+};
+
+Immediate immediate = {};
+
+void init_sgl() {
+  sgl_desc_t desc = {};
+  desc.max_vertices = opts.sgl_max_vertices;
+  desc.max_commands = opts.sgl_max_commands;
+  desc.context_pool_size = SGL_MAX_CONTEXTS;
+  if (opts.post) {
+    desc.color_format = opts.post_format;
+    desc.depth_format = SG_PIXELFORMAT_NONE;
+  }
+  desc.logger.func = slog_func;
+  desc.allocator = tracking_allocator<sgl_allocator_t>(&gl_memory);
+  sgl_setup(&desc);
+
+  immediate.contexts[0] = sgl_default_context();
+  immediate.num_contexts = 1;
+
+  immediate.vertices.resize((size_t)opts.sgl * 3);
+  generate_triangles(immediate.vertices.data(), opts.sgl, 0.0f);
+
+  sg_buffer_desc buf_desc = {};
+  buf_desc.data = {immediate.vertices.data(),
+                   immediate.vertices.size() * sizeof(Vertex)};
+  buf_desc.label = "retained";
+  immediate.retained = sg_make_buffer(&buf_desc);
+}
+
+// Returns the next context to spill into, creating it on first use.
+sgl_context next_sgl_context(int index) {
+  if (index == immediate.num_contexts) {
+    sgl_context_desc_t desc = {};
+    desc.max_vertices = opts.sgl_max_vertices;
+    desc.max_commands = opts.sgl_max_commands;
+    if (opts.post) {
+      desc.color_format = opts.post_format;
+      desc.depth_format = SG_PIXELFORMAT_NONE;
+    }
+    immediate.contexts[immediate.num_contexts++] = sgl_make_context(&desc);
+  }
+  return immediate.contexts[index];
+}
+
+void draw_sgl() {
+  auto since = [](std::chrono::steady_clock::time_point t) {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(now - t).count();
+  };
+
+  auto begin = std::chrono::steady_clock::now();
+  {
+    sg_apply_pipeline(pips[0]);
+    sg_bindings bind = {};
+    bind.vertex_buffers[0] = immediate.retained;
+    sg_apply_bindings(&bind);
+    sg_draw(0, opts.sgl * 3, 1);
+  }
+  immediate.retained_ms += since(begin);
+
+  begin = std::chrono::steady_clock::now();
+
+  // every batch takes at most one command, merged or not
+  int ctx_index = 0;
+  int ctx_vertices = 0;
+  int ctx_commands = 0;
+  sgl_set_context(immediate.contexts[0]);
+  sgl_defaults();
+
+  int batch_index = 0;
+  for (int first = 0; first < opts.sgl; first += opts.sgl_batch) {
+    int count = opts.sgl - first < opts.sgl_batch ? opts.sgl - first
+                                                  : opts.sgl_batch;
+    bool brk = opts.sgl_break_every > 0 && batch_index > 0 &&
+               batch_index % opts.sgl_break_every == 0;
+
+    if (ctx_vertices + count * 3 > opts.sgl_max_vertices ||
+        ctx_commands + 1 > opts.sgl_max_commands) {
+      if (ctx_index + 1 == SGL_MAX_CONTEXTS) {
+        break;
+      }
+
+      sgl_set_context(next_sgl_context(++ctx_index));
+      sgl_defaults();
+      ctx_vertices = 0;
+      ctx_commands = 0;
+      immediate.splits++;
+    }
+
+    if (brk) {
+      // marks the matrix dirty, so the next batch can't be merged
+      sgl_load_identity();
+    }
+
+    sgl_begin_triangles();
+    const Vertex *v = &immediate.vertices[(size_t)first * 3];
+    for (int i = 0; i < count * 3; i++) {
+      sgl_v3f_c4f(v[i].position[0], v[i].position[1], v[i].position[2],
+                  v[i].color[0], v[i].color[1], v[i].color[2],
+                  v[i].color[3]);
+    }
+    sgl_end();
+
+    ctx_vertices += count * 3;
+    ctx_commands++;
+    batch_index++;
+  }
+  immediate.batches += batch_index;
+  immediate.submit_ms += since(begin);
+
+  begin = std::chrono::steady_clock::now();
+  int draws_before = profiler.current.draw;
+  for (int i = 0; i <= ctx_index; i++) {
+    if (sgl_context_error(immediate.contexts[i]) != SGL_NO_ERROR) {
+      immediate.dropped_frames++;
+    }
+    sgl_context_draw(immediate.contexts[i]);
+  }
+  immediate.draws += profiler.current.draw - draws_before;
+  immediate.draw_ms += since(begin);
+
+  sgl_set_context(sgl_default_context());
+  immediate.frame++;
+}
+
+void print_sgl_stats() {
+  if (immediate.frame == 0) {
+    return;
+  }
+
+  double frames = (double)immediate.frame;
+  double vertices = opts.sgl * 3.0 * frames;
+  printf("sokol_gl: %d triangles, %d per batch, max %d vertices and %d "
+         "commands per context\n",
+         opts.sgl, opts.sgl_batch, opts.sgl_max_vertices,
+         opts.sgl_max_commands);
+  printf("  per frame: %.1f batches, %.1f draws issued, %.1f batches merged, "
+         "%.1f context splits, %lld contexts dropped a frame\n",
+         immediate.batches / frames, immediate.draws / frames,
+         (immediate.batches - immediate.draws) / frames,
+         immediate.splits / frames, immediate.dropped_frames);
+#if defined(SOKOL_DUMMY_BACKEND)
+  // the retained path is one sg_draw, which the dummy backend does no
+  // per-vertex work for, so dividing it by the vertex count means nothing
+  printf("  retained sg_buffer: one sg_draw, no per-vertex cost without a "
+         "GPU backend\n");
+#else
+  printf("  retained sg_buffer: %.2f ns/vertex\n",
+         immediate.retained_ms * 1e6 / vertices);
+#endif
+  printf("  sokol_gl: %.2f ns/vertex (%.2f submitting, %.2f in sgl_draw)\n",
+         (immediate.submit_ms + immediate.draw_ms) * 1e6 / vertices,
+         immediate.submit_ms * 1e6 / vertices,
+         immediate.draw_ms * 1e6 / vertices);
+}
+
+void print_stream_stats() {
+  if (stream.frame == 0) {
+    return;
+  }
+
+  double frames = (double)stream.frame;
+  printf("stream: %d vertex budget (%.1f MB), %d triangles in %d chunks\n",
+         opts.stream, sizeof(Vertex) * opts.stream / (1024.0 * 1024.0),
+         opts.stream_triangles, opts.stream_chunks);
+  printf("  %.1f MB/frame appended, %lld overflow frames, "
+         "%lld triangles dropped\n",
+         stream.bytes / frames / (1024.0 * 1024.0), stream.overflows,
+         stream.dropped_triangles);
+  printf("  %.3f ms/frame generating, %.3f ms/frame generating + "
+         "appending + drawing\n",
+         stream.gen_ms / frames, stream.frame_ms / frames);
+}
+
+enum PostKind {
+  POST_BLUR,
+  POST_TONEMAP,
+  POST_DOWNSAMPLE,
+  POST_BLIT,
+  NUM_POST_KINDS,
+};
+
+// Texture fetches per output pixel, for the bandwidth estimate. The blur
+// folds its 9 taps into 5 bilinear fetches.
+constexpr int POST_TAPS[NUM_POST_KINDS] = {5, 1, 4, 1};
+
+constexpr int POST_MAX_TARGETS = 16;
+
+struct PostPass {
+  const char *name;
+  PostKind kind;
+  float axis[2];
+
+  long long pixels;
+  long long bytes_read;
+  long long bytes_written;
+  double cpu_ms;
+  double finish_ms; // with --sync-timing only
+};
+
+struct RenderTarget {
+  sg_image image;
+  sg_pass pass;
+  int width;
+  int height;
+  sg_pixel_format format;
+  bool in_use;
+};
+
+struct PostPipeline {
+  PostKind kind;
+  sg_pixel_format format;
+  sg_pipeline pip;
+};
+
+struct Post {
+  std::vector<PostPass> passes;
+  sg_buffer fullscreen;
+  sg_shader shaders[NUM_POST_KINDS];
+  std::vector<PostPipeline> pipelines;
+
+  RenderTarget targets[POST_MAX_TARGETS];
+  int num_targets;
+  long long hits;
+  long long misses;
+  long long evictions;
+  long long live_bytes;
+  long long peak_bytes;
+
+  long long frame;
+};
+
+Post post = {};
+
+int pixel_bytes(sg_pixel_format format) {
+  switch (format) {
+  case SG_PIXELFORMAT_RGBA16F:
+    return 8;
+  default:
+    return 4;
+  }
+}
+
+const char *post_vs = GLSL_VERSION R"(
+  layout(location=0) in vec2 a_position;
+
+  out vec2 v_uv;
+
+  void main() {
+    gl_Position = vec4(a_position, 0.0, 1.0);
+    v_uv = a_position * 0.5 + 0.5;
+  }
+)";
+
+// params.xy is one source texel along the blur axis, or one source texel for
+// the downsample; params.z is the tonemap exposure.
+const char *post_fs[NUM_POST_KINDS] = {
+    GLSL_VERSION R"(
+      uniform vec4 params;
+      uniform sampler2D tex;
+
+      in vec2 v_uv;
+      out vec4 f_color;
+
+      void main() {
+        vec2 s = params.xy;
+        vec4 c = texture(tex, v_uv) * 0.2270270270;
+        c += (texture(tex, v_uv + s * 1.3846153846) +
+              texture(tex, v_uv - s * 1.3846153846)) * 0.3162162162;
+        c += (texture(tex, v_uv + s * 3.2307692308) +
+              texture(tex, v_uv - s * 3.2307692308)) * 0.0702702703;
+        f_color = c;
+      }
+    )",
+    GLSL_VERSION R"(
+      uniform vec4 params;
+      uniform sampler2D tex;
+
+      in vec2 v_uv;
+      out vec4 f_color;
+
+      void main() {
+        vec3 c = texture(tex, v_uv).rgb * params.z;
+        c = c / (1.0 + c);
+        f_color = vec4(pow(c, vec3(1.0 / 2.2)), 1.0);
+      }
+    )",
+    GLSL_VERSION R"(
+      uniform vec4 params;
+      uniform sampler2D tex;
+
+      in vec2 v_uv;
+      out vec4 f_color;
+
+      void main() {
+        vec2 s = params.xy * 0.5;
+        f_color = (texture(tex, v_uv + vec2(-s.x, -s.y)) +
+                   texture(tex, v_uv + vec2(+s.x, -s.y)) +
+                   texture(tex, v_uv + vec2(-s.x, +s.y)) +
+                   texture(tex, v_uv + vec2(+s.x, +s.y))) * 0.25;
+      }
+    )",
+    GLSL_VERSION R"(
+      uniform vec4 params;
+      uniform sampler2D tex;
+
+      in vec2 v_uv;
+      out vec4 f_color;
+
+      void main() {
+        f_color = texture(tex, v_uv);
+      }
+    )",
+};
+
+void add_post_pass(const char *name, PostKind kind, float x, float y) {
+  PostPass pass = {};
+  pass.name = name;
+  pass.kind = kind;
+  pass.axis[0] = x;
+  pass.axis[1] = y;
+  post.passes.push_back(pass);
+}
+
+void init_post() {
+  char chain[256];
+  snprintf(chain, sizeof(chain), "%s", opts.post);
+  for (char *stage = strtok(chain, ","); stage; stage = strtok(nullptr, ",")) {
+    if (strcmp(stage, "blur") == 0) {
+      add_post_pass("blur-h", POST_BLUR, 1.0f, 0.0f);
+      add_post_pass("blur-v", POST_BLUR, 0.0f, 1.0f);
+    } else if (strcmp(stage, "tonemap") == 0) {
+      add_post_pass("tonemap", POST_TONEMAP, 0.0f, 0.0f);
+    } else if (strcmp(stage, "downsample") == 0) {
+      add_post_pass("downsample", POST_DOWNSAMPLE, 1.0f, 1.0f);
+    } else {
+      fprintf(stderr, "unknown post stage '%s', skipped\n", stage);
+    }
+  }
+  add_post_pass("blit", POST_BLIT, 0.0f, 0.0f);
+
+  float vertices[] = {-1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f};
+  sg_buffer_desc buf_desc = {};
+  buf_desc.data = SG_RANGE(vertices);
+  buf_desc.label = "fullscreen";
+  post.fullscreen = sg_make_buffer(&buf_desc);
+
+  for (int i = 0; i < NUM_POST_KINDS; i++) {
+    sg_shader_desc desc = {};
+    desc.vs.source = post_vs;
+    desc.fs.source = post_fs[i];
+    desc.fs.uniform_blocks[0].size = sizeof(float) * 4;
+    desc.fs.uniform_blocks[0].uniforms[0] = {"params", SG_UNIFORMTYPE_FLOAT4,
+                                             0};
+    desc.fs.images[0].name = "tex";
+    desc.fs.images[0].image_type = SG_IMAGETYPE_2D;
+    post.shaders[i] = sg_make_shader(&desc);
+  }
+}
+
+// Offscreen pipelines render without depth. _SG_PIXELFORMAT_DEFAULT means the
+// default pass.
+sg_pipeline post_pipeline(PostKind kind, sg_pixel_format format) {
+  for (const PostPipeline &p : post.pipelines) {
+    if (p.kind == kind && p.format == format) {
+      return p.pip;
+    }
+  }
+
+  sg_pipeline_desc desc = {};
+  desc.shader = post.shaders[kind];
+  desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT2;
+  if (format != _SG_PIXELFORMAT_DEFAULT) {
+    desc.colors[0].pixel_format = format;
+    desc.depth.pixel_format = SG_PIXELFORMAT_NONE;
+  }
+  sg_pipeline pip = sg_make_pipeline(&desc);
+  post.pipelines.push_back({kind, format, pip});
+  return pip;
+}
+
+// Hands out a free image of the given size and format, creating one if there
+// is none. When the pool is full, a free image of some other size is
+// replaced, e.g. after a resize.
+int acquire_target(int width, int height, sg_pixel_format format) {
+  int reuse = -1;
+  for (int i = 0; i < post.num_targets; i++) {
+    RenderTarget &t = post.targets[i];
+    if (t.in_use) {
+      continue;
+    }
+    if (t.width == width && t.height == height && t.format == format) {
+      t.in_use = true;
+      post.hits++;
+      return i;
+    }
+    reuse = i;
+  }
+
+  int index = post.num_targets;
+  if (post.num_targets < POST_MAX_TARGETS) {
+    post.num_targets++;
+  } else if (reuse >= 0) {
+    RenderTarget &t = post.targets[reuse];
+    sg_destroy_pass(t.pass);
+    sg_destroy_image(t.image);
+    post.live_bytes -= (long long)t.width * t.height * pixel_bytes(t.format);
+    post.evictions++;
+    index = reuse;
+  } else {
+    fprintf(stderr, "all %d post targets are in use\n", POST_MAX_TARGETS);
+    abort();
+  }
+
+  RenderTarget &t = post.targets[index];
+  t = {};
+  t.width = width;
+  t.height = height;
+  t.format = format;
+  t.in_use = true;
+
+  sg_image_desc img_desc = {};
+  img_desc.render_target = true;
+  img_desc.width = width;
+  img_desc.height = height;
+  img_desc.pixel_format = format;
+  img_desc.min_filter = SG_FILTER_LINEAR;
+  img_desc.mag_filter = SG_FILTER_LINEAR;
+  img_desc.wrap_u = SG_WRAP_CLAMP_TO_EDGE;
+  img_desc.wrap_v = SG_WRAP_CLAMP_TO_EDGE;
+  img_desc.label = "post-target";
+  t.image = sg_make_image(&img_desc);
+
+  sg_pass_desc pass_desc = {};
+  pass_desc.color_attachments[0].image = t.image;
+  pass_desc.label = "post-pass";
+  t.pass = sg_make_pass(&pass_desc);
+
+  post.misses++;
+  post.live_bytes += (long long)width * height * pixel_bytes(format);
+  if (post.live_bytes > post.peak_bytes) {
+    post.peak_bytes = post.live_bytes;
+  }
+  return index;
+}
+
+void release_target(int index) { post.targets[index].in_use = false; }
+
+// Runs the chain over the scene target and blits the result to the default
+// pass. Every pass overwrites its whole target, so none of them load or clear.
+void run_post_chain(int src) {
+  sg_pass_action pass_action = {};
+  pass_action.colors[0].load_action = SG_LOADACTION_DONTCARE;
+  pass_action.depth.load_action = SG_LOADACTION_DONTCARE;
+  pass_action.stencil.load_action = SG_LOADACTION_DONTCARE;
+
+#if defined(HEADLESS_EGL)
+  // the GL backend issues every call right away, so with the GPU idle before
+  // a pass, glFinish after it returns once that pass alone has been drawn
+  if (opts.sync_timing) {
+    glFinish();
+  }
+#endif
+
+  for (PostPass &p : post.passes) {
+    auto begin = std::chrono::steady_clock::now();
+
+    const RenderTarget &in = post.targets[src];
+    int width = in.width;
+    int height = in.height;
+    sg_pixel_format format = in.format;
+    if (p.kind == POST_DOWNSAMPLE) {
+      width = std::max(width / 2, 1);
+      height = std::max(height / 2, 1);
+    } else if (p.kind == POST_TONEMAP) {
+      format = SG_PIXELFORMAT_RGBA8;
+    }
+
+    int dst = -1;
+    sg_push_debug_group(p.name);
+    if (p.kind == POST_BLIT) {
+      width = frame_width();
+      height = frame_height();
+      sg_begin_default_pass(&pass_action, width, height);
+      sg_apply_pipeline(post_pipeline(p.kind, _SG_PIXELFORMAT_DEFAULT));
+    } else {
+      dst = acquire_target(width, height, format);
+      sg_begin_pass(post.targets[dst].pass, &pass_action);
+      sg_apply_pipeline(post_pipeline(p.kind, format));
+    }
+
+    sg_bindings bind = {};
+    bind.vertex_buffers[0] = post.fullscreen;
+    bind.fs_images[0] = in.image;
+    sg_apply_bindings(&bind);
+
+    float params[4] = {p.axis[0] / in.width, p.axis[1] / in.height, 1.0f,
+                       0.0f};
+    sg_range range = SG_RANGE(params);
+    sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, &range);
+    sg_draw(0, 3, 1);
+    sg_end_pass();
+    sg_pop_debug_group();
+
+    long long pixels = (long long)width * height;
+    p.pixels += pixels;
+    p.bytes_read += pixels * POST_TAPS[p.kind] * pixel_bytes(in.format);
+    p.bytes_written += pixels * pixel_bytes(format);
+
+    release_target(src);
+    src = dst;
+
+    auto end = std::chrono::steady_clock::now();
+    p.cpu_ms += std::chrono::duration<double, std::milli>(end - begin).count();
+
+#if defined(HEADLESS_EGL)
+    if (opts.sync_timing) {
+      glFinish();
+      end = std::chrono::steady_clock::now();
+      p.finish_ms +=
+          std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+#endif
+  }
+
+  post.frame++;
+}
+
+void print_post_stats() {
+  if (post.frame == 0) {
+    return;
+  }
+
+  double frames = (double)post.frame;
+  printf("post chain: %s\n", opts.post);
+  for (const PostPass &p : post.passes) {
+    printf("  %-10s  %6.2f Mpixels, %7.2f MB read, %7.2f MB written, "
+           "%.1f us cpu",
+           p.name, p.pixels / frames / 1e6,
+           p.bytes_read / frames / (1024.0 * 1024.0),
+           p.bytes_written / frames / (1024.0 * 1024.0),
+           p.cpu_ms * 1000.0 / frames);
+    if (opts.sync_timing) {
+      printf(", %.1f us to finish", p.finish_ms * 1000.0 / frames);
+    }
+    printf(" per frame\n");
+  }
+  printf("  targets: %d images, %.2f MB live, %.2f MB peak, %lld hits, "
+         "%lld misses, %lld evictions\n",
+         post.num_targets, post.live_bytes / (1024.0 * 1024.0),
+         post.peak_bytes / (1024.0 * 1024.0), post.hits, post.misses,
+         post.evictions);
+}
 
 void init() {
   sg_desc desc = {};
+#if !defined(HEADLESS)
   desc.context = sapp_sgcontext();
+#endif
   desc.logger.func = slog_func;
+  desc.allocator = tracking_allocator<sg_allocator>(&gfx_memory);
+  desc.disable_validation = opts.disable_validation;
+  // 25% headroom like load_pool_profile, so what init() itself makes stays
+  // below the --pool-stats warning threshold
+  desc.buffer_pool_size = std::max(128, opts.buffers + opts.buffers / 4 + 16);
+  desc.pipeline_pool_size =
+      std::max(64, opts.pipelines + opts.pipelines / 4 + 16);
+  if (opts.sgl > 0) {
+    desc.buffer_pool_size += SGL_MAX_CONTEXTS;
+    desc.pipeline_pool_size += SGL_MAX_CONTEXTS * SGL_PIPELINES_PER_CONTEXT;
+  }
+  if (opts.post) {
+    desc.pass_pool_size = POST_MAX_TARGETS + 16;
+  }
+  if (opts.churn > 0) {
+    desc.buffer_pool_size += opts.churn + opts.churn / 4;
+    desc.image_pool_size = 128 + opts.churn + opts.churn / 4;
+  }
+  if (opts.pool_load) {
+    load_pool_profile(&desc);
+  }
   sg_setup(&desc);
 
-  struct Vertex {
-    float position[3];
-    float color[4];
-  };
+  // --sgl uses the draw counter to see how many batches were merged
+  if (opts.profile || opts.sgl > 0) {
+    install_profiler();
+  }
 
-  vbuf = {};
-  {
+  if (opts.pool_stats) {
+    install_pool_monitor();
+  }
+
+  vbufs.resize(opts.buffers);
+  for (sg_buffer &vbuf : vbufs) {
     Vertex vertices[] = {
         {{+0.0f, +0.5f, 0.0f}, {1.0f, 0.0f, 0.0f, 1.0f}},
         {{-0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}},
@@ -40,9 +1639,7 @@ void init() {
   {
     sg_shader_desc desc = {};
 
-    desc.vs.source = R"(
-      #version 330 core
-
+    desc.vs.source = GLSL_VERSION R"(
       layout(location=0) in vec3 a_position;
       layout(location=1) in vec4 a_color;
 
@@ -54,9 +1651,7 @@ void init() {
       }
     )";
 
-    desc.fs.source = R"(
-      #version 330 core
-
+    desc.fs.source = GLSL_VERSION R"(
       in vec4 v_color;
       out vec4 f_color;
 
@@ -68,36 +1663,415 @@ void init() {
     shd = sg_make_shader(&desc);
   }
 
-  pip = {};
-  {
+  pips.resize(opts.pipelines);
+  for (sg_pipeline &pip : pips) {
     sg_pipeline_desc desc = {};
     desc.shader = shd;
     desc.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT3;
     desc.layout.attrs[1].format = SG_VERTEXFORMAT_FLOAT4;
+    if (opts.post) {
+      desc.colors[0].pixel_format = opts.post_format;
+      desc.depth.pixel_format = SG_PIXELFORMAT_NONE;
+    }
     pip = sg_make_pipeline(&desc);
   }
+
+  if (opts.stream > 0) {
+    init_stream();
+  }
+
+  if (opts.sgl > 0) {
+    init_sgl();
+  }
+
+  if (opts.post) {
+    init_post();
+  }
+}
+
+// Draws are grouped by pipeline, as if sorted by state, and cycle through the
+// vertex buffers within each group.
+void draw_scene() {
+  int pip_index = -1;
+  for (int i = 0; i < opts.draws; i++) {
+    int next_pip = (int)((long long)i * opts.pipelines / opts.draws);
+    if (next_pip != pip_index) {
+      pip_index = next_pip;
+      sg_apply_pipeline(pips[pip_index]);
+    }
+
+    sg_bindings bind = {};
+    bind.vertex_buffers[0] = vbufs[i % opts.buffers];
+    sg_apply_bindings(&bind);
+    sg_draw(0, 3, 1);
+  }
+}
+
+struct Churn {
+  std::vector<sg_buffer> buffers;
+  std::vector<sg_image> images;
+  long long rounds;
+  double buffer_make_ns;
+  double buffer_destroy_ns;
+  double image_make_ns;
+  double image_destroy_ns;
+};
+
+Churn churn = {};
+
+// Destroys every other resource first and then the rest, so the free slots
+// don't come back in the order they were handed out.
+template <typename T, typename Destroy>
+double destroy_shuffled(std::vector<T> *resources, Destroy destroy) {
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < resources->size(); i += 2) {
+    destroy((*resources)[i]);
+  }
+  for (size_t i = 1; i < resources->size(); i += 2) {
+    destroy((*resources)[i]);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+// Runs outside any pass. Dynamic resources skip the initial upload, so this
+// mostly measures handle allocation and validation.
+void churn_resources() {
+  churn.buffers.resize(opts.churn);
+  churn.images.resize(opts.churn);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (sg_buffer &buf : churn.buffers) {
+    sg_buffer_desc desc = {};
+    desc.size = 256;
+    desc.usage = SG_USAGE_DYNAMIC;
+    buf = sg_make_buffer(&desc);
+  }
+  auto end = std::chrono::steady_clock::now();
+  churn.buffer_make_ns +=
+      std::chrono::duration<double, std::nano>(end - begin).count();
+  churn.buffer_destroy_ns += destroy_shuffled(&churn.buffers, sg_destroy_buffer);
+
+  begin = std::chrono::steady_clock::now();
+  for (sg_image &img : churn.images) {
+    sg_image_desc desc = {};
+    desc.width = 4;
+    desc.height = 4;
+    desc.usage = SG_USAGE_DYNAMIC;
+    img = sg_make_image(&desc);
+  }
+  end = std::chrono::steady_clock::now();
+  churn.image_make_ns +=
+      std::chrono::duration<double, std::nano>(end - begin).count();
+  churn.image_destroy_ns += destroy_shuffled(&churn.images, sg_destroy_image);
+
+  churn.rounds++;
+}
+
+void print_churn_stats() {
+  if (churn.rounds == 0) {
+    return;
+  }
+
+  double calls = (double)churn.rounds * opts.churn;
+  printf("churn: %d buffers and %d images per frame\n", opts.churn,
+         opts.churn);
+  printf("  sg_make_buffer %.1f ns, sg_destroy_buffer %.1f ns\n",
+         churn.buffer_make_ns / calls, churn.buffer_destroy_ns / calls);
+  printf("  sg_make_image %.1f ns, sg_destroy_image %.1f ns\n",
+         churn.image_make_ns / calls, churn.image_destroy_ns / calls);
+}
+
+// With --post, the scene goes into a pooled target, whose index is returned,
+// rather than the default pass.
+int begin_scene_pass(const sg_pass_action *pass_action) {
+  if (!opts.post) {
+    sg_begin_default_pass(pass_action, frame_width(), frame_height());
+    return -1;
+  }
+
+  int scene = acquire_target(frame_width(), frame_height(), opts.post_format);
+  sg_begin_pass(post.targets[scene].pass, pass_action);
+  return scene;
 }
 
 void frame() {
+  if (opts.churn > 0) {
+    churn_resources();
+  }
+
   sg_pass_action pass_action = {};
   pass_action.colors[0].load_action = SG_LOADACTION_CLEAR;
   pass_action.colors[0].clear_value = {0.5f, 0.5f, 0.5f, 1.0f};
-  sg_begin_default_pass(&pass_action, sapp_width(), sapp_height());
+  int scene = begin_scene_pass(&pass_action);
+
+  if (opts.stream > 0) {
+    draw_stream();
+  } else if (opts.sgl > 0) {
+    draw_sgl();
+  } else {
+    draw_scene();
+  }
+
+  sg_end_pass();
+  if (opts.post) {
+    run_post_chain(scene);
+  }
+  sg_commit();
+}
+
+void cleanup() {
+  if (opts.pool_stats) {
+    uninstall_pool_monitor();
+  }
+
+  if (opts.profile || opts.sgl > 0) {
+    uninstall_profiler();
+  }
+
+  if (opts.sgl > 0) {
+    print_sgl_stats();
+    for (int i = 1; i < immediate.num_contexts; i++) {
+      sgl_destroy_context(immediate.contexts[i]);
+    }
+    immediate = {};
+    sgl_shutdown();
+  }
+
+  if (opts.stream > 0) {
+    print_stream_stats();
+    stream = {};
+  }
+
+  if (opts.post) {
+    print_post_stats();
+    post = {};
+  }
+
+  if (opts.churn > 0) {
+    print_churn_stats();
+    churn = {};
+  }
+
+  vbufs.clear();
+  pips.clear();
+  sg_shutdown();
+
+  // sokol_app is still up here, so only its live bytes can be nonzero
+  if (opts.track_memory) {
+    print_memory_stats();
+  }
+}
+
+const char *usage =
+    "usage: %s [--pipelines N] [--buffers N] [--draws N] [--profile] "
+    "[--profile-csv out.csv] [--profile-print N] [--stream N] "
+    "[--stream-triangles N] [--stream-chunks N] [--sgl N] [--sgl-batch N] "
+    "[--sgl-break-every N] [--sgl-max-vertices N] [--sgl-max-commands N] "
+    "[--track-memory] [--memory-pools] [--memory-cap MB] "
+    "[--post blur,tonemap,downsample,...] [--post-format FORMAT] "
+    "[--pool-stats] [--pool-record out.txt] [--pool-load in.txt] [--churn N]"
+#if defined(HEADLESS)
+    " [--frames N] [--calls N] [--size WxH]"
+#endif
+#if defined(HEADLESS_EGL)
+    " [--sync-timing]"
+#endif
+    "\n";
+
+#if defined(HEADLESS)
+double elapsed_ns(std::chrono::steady_clock::time_point begin) {
+  auto end = std::chrono::steady_clock::now();
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end -
+                                                                      begin)
+      .count();
+}
+#endif
+
+#if defined(SOKOL_DUMMY_BACKEND)
+// Times opts.calls sg_apply_bindings and sg_draw calls in isolation, inside
+// a single pass with one pipeline applied.
+void bench_calls(double *bindings_ns, double *draw_ns) {
+  sg_pass_action pass_action = {};
+  int scene = begin_scene_pass(&pass_action);
+  sg_apply_pipeline(pips[0]);
 
   sg_bindings bind = {};
-  bind.vertex_buffers[0] = vbuf;
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < opts.calls; i++) {
+    bind.vertex_buffers[0] = vbufs[i % opts.buffers];
+    sg_apply_bindings(&bind);
+  }
+  *bindings_ns = elapsed_ns(begin) / opts.calls;
 
-  sg_apply_pipeline(pip);
-  sg_apply_bindings(&bind);
-  sg_draw(0, 3, 1);
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < opts.calls; i++) {
+    sg_draw(0, 3, 1);
+  }
+  *draw_ns = elapsed_ns(begin) / opts.calls;
 
   sg_end_pass();
+  if (scene >= 0) {
+    release_target(scene);
+  }
   sg_commit();
 }
 
-void cleanup() { sg_shutdown(); }
+void bench(bool validation) {
+  opts.disable_validation = !validation;
+  reset_memory_stats();
+
+  auto begin = std::chrono::steady_clock::now();
+  init();
+  double init_ns = elapsed_ns(begin);
+
+  // warm up the pools and caches before timing anything
+  for (int i = 0; i < 10; i++) {
+    frame();
+  }
+
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < opts.frames; i++) {
+    frame();
+  }
+  double frame_ns = elapsed_ns(begin) / opts.frames;
+
+  double bindings_ns = 0;
+  double draw_ns = 0;
+  bench_calls(&bindings_ns, &draw_ns);
+
+  cleanup();
+
+  printf("validation %s:\n", validation ? "on" : "off");
+  printf("  init: %.3f ms\n", init_ns / 1e6);
+  // only the plain scene issues exactly opts.draws draws per frame
+  printf("  frame: %.0f ns", frame_ns);
+  if (opts.stream == 0 && opts.sgl == 0 && !opts.post) {
+    printf(", %.1f ns per draw", frame_ns / opts.draws);
+  }
+  printf("\n");
+  printf("  sg_apply_bindings: %.1f ns, sg_draw: %.1f ns\n", bindings_ns,
+         draw_ns);
+}
+
+int main(int argc, char **argv) {
+  if (!parse_options(argc, argv)) {
+    fprintf(stderr, usage, argv[0]);
+    return 1;
+  }
+
+  printf("dummy backend: %d pipelines, %d buffers, %d draws/frame, "
+         "%d frames, %d isolated calls\n",
+         opts.pipelines, opts.buffers, opts.draws, opts.frames, opts.calls);
+#if !defined(SOKOL_DEBUG)
+  printf("SOKOL_DEBUG is not defined, so there is no validation layer\n");
+#endif
+
+  bench(true);
+  bench(false);
+}
+#endif
 
+#if defined(HEADLESS_EGL)
+struct Egl {
+  HeadlessEgl headless;
+  GLuint fbo;
+  GLuint color;
+  GLuint depth;
+};
+
+Egl egl = {};
+
+// Creates a GLES 3.0 context and an FBO that stands in for the window. The
+// FBO matches the default pass formats sokol_gfx assumes (RGBA8 and
+// depth-stencil), and stays bound: sg_setup() takes whatever framebuffer is
+// bound at that point as the default framebuffer.
+bool create_egl(int width, int height) {
+  if (!create_headless_egl(&egl.headless, true, 3, 0)) {
+    return false;
+  }
+
+  glGenRenderbuffers(1, &egl.color);
+  glBindRenderbuffer(GL_RENDERBUFFER, egl.color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenRenderbuffers(1, &egl.depth);
+  glBindRenderbuffer(GL_RENDERBUFFER, egl.depth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+  glGenFramebuffers(1, &egl.fbo);
+  glBindFramebuffer(GL_FRAMEBUFFER, egl.fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, egl.color);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                            GL_RENDERBUFFER, egl.depth);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf(stderr, "headless framebuffer is incomplete\n");
+    return false;
+  }
+
+  print_headless_egl(&egl.headless, (const char *)glGetString(GL_RENDERER),
+                     (const char *)glGetString(GL_VERSION));
+  return true;
+}
+
+void destroy_egl() {
+  glDeleteFramebuffers(1, &egl.fbo);
+  glDeleteRenderbuffers(1, &egl.color);
+  glDeleteRenderbuffers(1, &egl.depth);
+  destroy_headless_egl(&egl.headless);
+  egl = {};
+}
+
+int main(int argc, char **argv) {
+  if (!parse_options(argc, argv)) {
+    fprintf(stderr, usage, argv[0]);
+    return 1;
+  }
+
+  if (!create_egl(opts.width, opts.height)) {
+    return 1;
+  }
+
+  init();
+
+  // warm up shader compilation and driver caches before timing anything
+  for (int i = 0; i < 10; i++) {
+    frame();
+  }
+  glFinish();
+
+  // frame() only queues GL commands, so the time until glFinish returns is
+  // what the GPU (or llvmpipe) actually took
+  std::vector<double> cpu_ms;
+  std::vector<double> frame_ms;
+  cpu_ms.reserve(opts.frames);
+  frame_ms.reserve(opts.frames);
+  for (int i = 0; i < opts.frames; i++) {
+    auto begin = std::chrono::steady_clock::now();
+    frame();
+    cpu_ms.push_back(elapsed_ns(begin) / 1e6);
+    glFinish();
+    frame_ms.push_back(elapsed_ns(begin) / 1e6);
+  }
+
+  cleanup();
+  destroy_egl();
+
+  printf("%d frames at %dx%d\n", opts.frames, opts.width, opts.height);
+  print_percentiles("frame() cpu", &cpu_ms);
+  print_percentiles("frame + glFinish", &frame_ms);
+}
+#endif
+
+#if !defined(HEADLESS)
 sapp_desc sokol_main(int argc, char **argv) {
+  if (!parse_options(argc, argv)) {
+    fprintf(stderr, usage, argv[0]);
+    exit(1);
+  }
+
   sapp_desc desc = {};
   desc.init_cb = init;
   desc.frame_cb = frame;
@@ -106,5 +2080,7 @@ sapp_desc sokol_main(int argc, char **argv) {
   desc.height = 600;
   desc.window_title = "Sokol";
   desc.logger.func = slog_func;
+  desc.allocator = tracking_allocator<sapp_allocator>(&app_memory);
   return desc;
-}
\ No newline at end of file
+}
+#endif